@@ -0,0 +1,218 @@
+// MICROBENCHMARKS DEL MOTOR (Google Benchmark)
+// Ejecutar:  ./gravity_bench --benchmark_out=resultados.json --benchmark_out_format=json
+// Filtrar:   ./gravity_bench --benchmark_filter='Aceleraciones<PrecisionMixta'
+// Argumentos de cada caso: N (cuerpos) y hilos (Aceleraciones::hilos); los casos que no
+// usan hilos solo N.
+// Contadores: 'interacciones/s' (pares de cuerpos evaluados por segundo: n(n-1)/2 con el
+// kernel simétrico de un hilo, n² con el reparto entre hilos, que no aprovecha la simetría) y
+// 'ns/cuerpo-paso' (tiempo de una llamada dividido por N; la consola le añade una 's'
+// por ser un contador invertido, pero el valor ya está en nanosegundos).
+
+#include <benchmark/benchmark.h>
+
+#include <gravedad/generadores.hpp>
+#include <gravedad/integradores.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+const double G = 0.001;
+const double EPS = 0.003;
+
+// Rejilla de argumentos: N en potencias de 10 entre NMIN y NMAX; con N >= 10^4 también
+// hilos en potencias de 2 hasta los disponibles (por debajo el motor no reparte).
+template <int64_t NMIN, int64_t NMAX>
+void rejilla(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"N", "hilos"});
+    const int64_t hilosMax = int64_t(hilosDisponibles());
+    for (int64_t n = NMIN; n <= NMAX; n *= 10) {
+        for (int64_t h = 1; h <= hilosMax; h *= 2) {
+            b->Args({n, h});
+            if (n < 10000) break;
+        }
+        if (n >= 10000 && (hilosMax & (hilosMax - 1)) != 0) b->Args({n, hilosMax});
+    }
+    b->Unit(benchmark::kMicrosecond);
+}
+
+// Solo N, para lo que no reparte entre hilos
+template <int64_t NMIN, int64_t NMAX>
+void rejillaN(benchmark::internal::Benchmark* b) {
+    b->ArgName("N");
+    for (int64_t n = NMIN; n <= NMAX; n *= 10) b->Arg(n);
+    b->Unit(benchmark::kMicrosecond);
+}
+
+// Pares que evalúa el motor con todos los cuerpos masivos. Mismo umbral que
+// detalle_fuerzas::acumular: con menos de 3 hilos efectivos, el kernel simétrico; con
+// más, cada bloque de sumideros recorre todas las fuentes.
+double paresEvaluados(size_t n, int64_t hilos) {
+    const size_t MIN_CUERPOS_POR_HILO = 1024;
+    const size_t efectivos = std::min<size_t>(size_t(hilos), n / MIN_CUERPOS_POR_HILO);
+    return efectivos >= 3 ? double(n) * double(n) : double(n) * double(n - 1) / 2.0;
+}
+
+void contadores(benchmark::State& st, double n, double interacciones) {
+    if (interacciones > 0.0)
+        st.counters["interacciones/s"] = benchmark::Counter(interacciones, benchmark::Counter::kIsIterationInvariantRate);
+    st.counters["ns/cuerpo-paso"] = benchmark::Counter(
+        n * 1e-9, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+// Esfera de Plummer con cuerpos todos masivos (el caso O(N²) completo)
+template <typename P>
+Particulas<P> esferaPlummer(size_t n) {
+    Particulas<P> p;
+    OpcionesGenerador op;
+    op.semilla = 12345;
+    generarPlummer(p, n, 1000.0, 0.5, G, op);
+    return p;
+}
+
+// KERNEL DE FUERZAS
+template <typename P, typename S>
+void BM_CalcularAceleraciones(benchmark::State& st) {
+    const size_t n = size_t(st.range(0));
+    Particulas<P> p = esferaPlummer<P>(n);
+    Aceleraciones<P> a;
+    a.hilos = unsigned(st.range(1));
+    const S suavizado{typename P::Calculo(EPS)};
+    for (auto _ : st) {
+        calcularAceleraciones(p, typename P::Calculo(G), suavizado, a);
+        benchmark::DoNotOptimize(a.ax.data());
+        benchmark::ClobberMemory();
+    }
+    contadores(st, double(n), paresEvaluados(n, st.range(1)));
+}
+
+// PASO COMPLETO DE EULER (fuerzas + velocidades)
+template <typename P>
+void BM_GravedadMutua(benchmark::State& st) {
+    const size_t n = size_t(st.range(0));
+    Particulas<P> p = esferaPlummer<P>(n);
+    Aceleraciones<P> a;
+    a.hilos = unsigned(st.range(1));
+    const SuavizadoPlummer<typename P::Calculo> suavizado{typename P::Calculo(EPS)};
+    const typename P::Almacen dt(1e-6);
+    for (auto _ : st) {
+        gravedadMutua(p, typename P::Calculo(G), suavizado, dt, a);
+        actualizarPosiciones(p, dt);
+        benchmark::ClobberMemory();
+    }
+    contadores(st, double(n), paresEvaluados(n, st.range(1)));
+}
+
+// PASO COMPLETO DE VERLET (calcularAceleraciones + actualización)
+template <typename P>
+void BM_GravedadVerlet(benchmark::State& st) {
+    const size_t n = size_t(st.range(0));
+    Particulas<P> p = esferaPlummer<P>(n);
+    const typename P::Almacen dt(1e-6);
+    prepararVerlet(p, dt);
+    Aceleraciones<P> a;
+    a.hilos = unsigned(st.range(1));
+    const SuavizadoPlummer<typename P::Calculo> suavizado{typename P::Calculo(EPS)};
+    for (auto _ : st) {
+        gravedadVerlet(p, typename P::Calculo(G), suavizado, dt, a);
+        benchmark::ClobberMemory();
+    }
+    contadores(st, double(n), paresEvaluados(n, st.range(1)));
+}
+
+// PARTÍCULAS DE PRUEBA: 16 fuentes masivas y N trazadores (kernel fuentes -> sumideros)
+template <typename P>
+void BM_ParticulasPrueba(benchmark::State& st) {
+    const size_t n = size_t(st.range(0));
+    const size_t FUENTES = 16;
+    Particulas<P> p;
+    OpcionesGenerador op;
+    op.semilla = 12345;
+    generarPlummer(p, FUENTES, 1000.0, 0.5, G, op);
+    ParametrosDisco d;
+    d.masaCentral = 0.0;
+    generarDisco(p, n, d, G, op);
+
+    Aceleraciones<P> a;
+    a.hilos = unsigned(st.range(1));
+    const SuavizadoPlummer<typename P::Calculo> suavizado{typename P::Calculo(EPS)};
+    for (auto _ : st) {
+        calcularAceleraciones(p, typename P::Calculo(G), suavizado, a);
+        benchmark::DoNotOptimize(a.ax.data());
+        benchmark::ClobberMemory();
+    }
+    contadores(st, double(n + FUENTES), double(FUENTES) * double(n + FUENTES));
+}
+
+// COLISIONES: todos los pares de una caja densa (muchos solapes). La copia del
+// estado va dentro del tiempo medido, pero es O(N) frente a los N²/2 pares.
+template <typename P>
+void BM_Collision(benchmark::State& st) {
+    const size_t n = size_t(st.range(0));
+    Particulas<P> original;
+    OpcionesGenerador op;
+    op.semilla = 12345;
+    op.radioCuerpo = 0.05;
+    generarCaja(original, n, 1.0, 1.0, 0.1, op);
+    Particulas<P> p;
+    for (auto _ : st) {
+        p = original;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = i + 1; j < n; ++j) Collision(p, i, j);
+        benchmark::ClobberMemory();
+    }
+    contadores(st, double(n), double(n) * double(n - 1) / 2.0);
+}
+
+// ACTUALIZACIÓN DE POSICIONES (parte O(N) del paso de Euler)
+template <typename P>
+void BM_ActualizarPosiciones(benchmark::State& st) {
+    const size_t n = size_t(st.range(0));
+    Particulas<P> p = esferaPlummer<P>(n);
+    for (auto _ : st) {
+        actualizarPosiciones(p, typename P::Almacen(1e-6));
+        benchmark::ClobberMemory();
+    }
+    contadores(st, double(n), 0.0);
+}
+
+} // namespace
+
+// Matriz completa precisión × suavizado hasta 10^4 cuerpos
+#define BENCH_ACELERACIONES(P) \
+    BENCHMARK_TEMPLATE(BM_CalcularAceleraciones, P, SuavizadoCorte<P::Calculo>)->Apply(rejilla<10, 10000>); \
+    BENCHMARK_TEMPLATE(BM_CalcularAceleraciones, P, SuavizadoPlummer<P::Calculo>)->Apply(rejilla<10, 10000>); \
+    BENCHMARK_TEMPLATE(BM_CalcularAceleraciones, P, SuavizadoSpline<P::Calculo>)->Apply(rejilla<10, 10000>);
+BENCH_ACELERACIONES(PrecisionSimple)
+BENCH_ACELERACIONES(PrecisionDoble)
+BENCH_ACELERACIONES(PrecisionExtendida)
+BENCH_ACELERACIONES(PrecisionMixta)
+
+// 10^5 cuerpos masivos solo en las precisiones de uso habitual
+BENCHMARK_TEMPLATE(BM_CalcularAceleraciones, PrecisionSimple, SuavizadoPlummer<PrecisionSimple::Calculo>)->Apply(rejilla<100000, 100000>);
+BENCHMARK_TEMPLATE(BM_CalcularAceleraciones, PrecisionMixta, SuavizadoPlummer<PrecisionMixta::Calculo>)->Apply(rejilla<100000, 100000>);
+
+#define BENCH_INTEGRADORES(P) \
+    BENCHMARK_TEMPLATE(BM_GravedadMutua, P)->Apply(rejilla<10, 10000>); \
+    BENCHMARK_TEMPLATE(BM_GravedadVerlet, P)->Apply(rejilla<10, 10000>); \
+    BENCHMARK_TEMPLATE(BM_ParticulasPrueba, P)->Apply(rejilla<10, 1000000>); \
+    BENCHMARK_TEMPLATE(BM_Collision, P)->Apply(rejillaN<10, 1000>); \
+    BENCHMARK_TEMPLATE(BM_ActualizarPosiciones, P)->Apply(rejillaN<10, 1000000>);
+BENCH_INTEGRADORES(PrecisionSimple)
+BENCH_INTEGRADORES(PrecisionDoble)
+BENCH_INTEGRADORES(PrecisionExtendida)
+BENCH_INTEGRADORES(PrecisionMixta)
+
+int main(int argc, char** argv) {
+    benchmark::AddCustomContext("hilos_disponibles", std::to_string(hilosDisponibles()));
+    benchmark::AddCustomContext("precisiones", nombrePrecision<PrecisionSimple>() + std::string(",") +
+                                nombrePrecision<PrecisionDoble>() + "," + nombrePrecision<PrecisionExtendida>() +
+                                "," + nombrePrecision<PrecisionMixta>());
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
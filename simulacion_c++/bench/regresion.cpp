@@ -0,0 +1,443 @@
+// BANCO DE REGRESIÓN DE RENDIMIENTO
+// Ejecuta escenas fijas sin ventana durante un número fijo de pasos de Verlet (la
+// misma configuración que simulador_verlet) y mide tiempo, pasos por segundo, memoria
+// pico y error de energía. Compara con una base guardada en JSON y termina con código
+// 1 si algo empeora más de la tolerancia.
+//
+//   ./gravity_regresion --base bench/base_regresion.json [--salida r.json]
+//                       [--tolerancia 0.10] [--tolerancia-memoria 0.10] [--tolerancia-energia 1.0]
+//                       [--escenas 4cuerpos,plummer10k] [--hilos N] [--actualizar]
+//
+// Con --actualizar se reescribe la base con los resultados actuales (hacerlo en la
+// máquina de referencia). Cada escena corre en un proceso hijo, así la memoria pico
+// es la suya y no la acumulada. Sin --hilos se usan los hilos con los que se midió
+// la base; si se piden otros no se compara.
+
+#include <gravedad/escenario.hpp>
+#include <gravedad/generadores.hpp>
+#include <gravedad/integradores.hpp>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef GRAVEDAD_DIR_ESCENARIOS
+#define GRAVEDAD_DIR_ESCENARIOS "escenarios"
+#endif
+
+namespace {
+
+// Mismos parámetros que main_verlet.cpp
+using PrecisionMotor = PrecisionMixta;
+const double G = 0.001;
+const double fixedDt = 0.001;
+const double epsSuavizado = 0.003;
+
+// ESCENAS
+struct Escena {
+    const char* nombre;
+    uint64_t pasos;
+};
+
+const Escena ESCENAS[] = {
+    {"4cuerpos", 1000000},  // escenarios/verlet.csv
+    {"plummer10k", 10},     // 10^4 cuerpos masivos: O(N²) puro
+    {"disco1M", 200},       // 10^6 trazadores alrededor de una masa central
+};
+
+bool crearEscena(const std::string& nombre, Particulas<PrecisionMotor>& p, unsigned hilos) {
+    if (nombre == "4cuerpos") return cargarEscenario(GRAVEDAD_DIR_ESCENARIOS "/verlet.csv", p, hilos);
+    if (nombre == "plummer10k") return generarEscena("plummer", 10000, 1, G, p);
+    if (nombre == "disco1M") return generarEscena("disco", 1000000, 1, G, p);
+    std::cerr << "Escena desconocida: " << nombre << "\n";
+    return false;
+}
+
+// ENERGÍA
+// Con potencial de Plummer (el mismo suavizado que las fuerzas). Los cuerpos masivos
+// dan la energía total; para los trazadores se guarda la energía específica de cada uno.
+struct Energia {
+    double masivos = 0.0;
+    std::vector<double> trazadores;
+};
+
+template <typename T>
+Energia calcularEnergia(const Particulas<PrecisionMotor>& p, const T* x, const T* y, const T* z) {
+    const size_t n = p.size();
+    const double eps2 = epsSuavizado * epsSuavizado;
+    std::vector<size_t> fuentes;
+    for (size_t i = 0; i < n; ++i)
+        if (!p.esPrueba(i)) fuentes.push_back(i);
+
+    Energia e;
+    for (size_t a = 0; a < fuentes.size(); ++a) {
+        const size_t i = fuentes[a];
+        const double v2 = double(p.vx[i] * p.vx[i] + p.vy[i] * p.vy[i] + p.vz[i] * p.vz[i]);
+        e.masivos += 0.5 * double(p.masa[i]) * v2;
+        for (size_t b = a + 1; b < fuentes.size(); ++b) {
+            const size_t j = fuentes[b];
+            const double dx = double(x[j] - x[i]), dy = double(y[j] - y[i]), dz = double(z[j] - z[i]);
+            e.masivos -= G * double(p.masa[i]) * double(p.masa[j]) / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (!p.esPrueba(i)) continue;
+        double ei = 0.5 * double(p.vx[i] * p.vx[i] + p.vy[i] * p.vy[i] + p.vz[i] * p.vz[i]);
+        for (size_t j : fuentes) {
+            const double dx = double(x[j] - x[i]), dy = double(y[j] - y[i]), dz = double(z[j] - z[i]);
+            ei -= G * double(p.masa[j]) / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+        }
+        e.trazadores.push_back(ei);
+    }
+    return e;
+}
+
+// Error relativo: el de la energía total de los masivos o la media de los trazadores,
+// el mayor de los dos
+double errorEnergia(const Energia& a, const Energia& b) {
+    double err = 0.0;
+    if (std::fabs(a.masivos) > 1e-300) err = std::fabs(b.masivos - a.masivos) / std::fabs(a.masivos);
+    if (!a.trazadores.empty()) {
+        double suma = 0.0;
+        for (size_t i = 0; i < a.trazadores.size(); ++i)
+            suma += std::fabs(b.trazadores[i] - a.trazadores[i]) / std::fabs(a.trazadores[i]);
+        err = std::max(err, suma / double(a.trazadores.size()));
+    }
+    return err;
+}
+
+// RESULTADO DE UNA ESCENA (viaja del hijo al padre por una tubería)
+struct Resultado {
+    bool ok = false;
+    uint64_t pasos = 0;
+    uint64_t cuerpos = 0;
+    double segundos = 0.0;
+    double pasosPorSegundo = 0.0;
+    double rssPicoMb = 0.0;
+    double errorEnergia = 0.0;
+};
+
+Resultado ejecutarEscena(const Escena& esc, unsigned hilos) {
+    Resultado r;
+    Particulas<PrecisionMotor> p;
+    if (!crearEscena(esc.nombre, p, hilos)) return r;
+    prepararVerlet(p, fixedDt);
+
+    Aceleraciones<PrecisionMotor> a;
+    a.hilos = hilos;
+    const SuavizadoPlummer<PrecisionMotor::Calculo> suavizado{PrecisionMotor::Calculo(epsSuavizado)};
+    Energia inicial = calcularEnergia(p, p.xPos.data(), p.yPos.data(), p.zPos.data());
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t paso = 0; paso < esc.pasos; ++paso)
+        gravedadVerlet(p, PrecisionMotor::Calculo(G), suavizado, fixedDt, a);
+    auto t1 = std::chrono::steady_clock::now();
+
+    // Tras gravedadVerlet, xPrev y v corresponden al mismo instante
+    Energia final = calcularEnergia(p, p.xPrev.data(), p.yPrev.data(), p.zPrev.data());
+
+    r.ok = true;
+    r.pasos = esc.pasos;
+    r.cuerpos = p.size();
+    r.segundos = std::chrono::duration<double>(t1 - t0).count();
+    r.pasosPorSegundo = double(esc.pasos) / r.segundos;
+    r.errorEnergia = errorEnergia(inicial, final);
+    return r;
+}
+
+// Ejecuta la escena en un proceso hijo y recoge su memoria pico con wait4
+Resultado ejecutarEnHijo(const Escena& esc, unsigned hilos) {
+    Resultado r;
+    int tubo[2];
+    if (pipe(tubo) != 0) {
+        std::cerr << "Error al crear la tubería\n";
+        return r;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "Error al crear el proceso de la escena " << esc.nombre << "\n";
+        close(tubo[0]);
+        close(tubo[1]);
+        return r;
+    }
+    if (pid == 0) {
+        close(tubo[0]);
+        Resultado hijo = ejecutarEscena(esc, hilos);
+        ssize_t escritos = write(tubo[1], &hijo, sizeof(hijo));
+        _exit(escritos == ssize_t(sizeof(hijo)) ? 0 : 1);
+    }
+
+    close(tubo[1]);
+    ssize_t leidos = read(tubo[0], &r, sizeof(r));
+    close(tubo[0]);
+    int estado = 0;
+    struct rusage uso;
+    wait4(pid, &estado, 0, &uso);
+    if (leidos != ssize_t(sizeof(r)) || !WIFEXITED(estado) || WEXITSTATUS(estado) != 0) {
+        r = Resultado();
+        return r;
+    }
+    r.rssPicoMb = double(uso.ru_maxrss) / 1024.0; // ru_maxrss viene en KiB
+    return r;
+}
+
+// JSON MÍNIMO
+// Solo lo necesario para leer la base que escribe este mismo programa:
+// {"escenas": {"nombre": {"clave": número, ...}, ...}}
+class LectorJson {
+public:
+    explicit LectorJson(const std::string& t) : texto(t) {}
+
+    // 'hilos' queda a 0 si la base no lo guarda
+    bool leer(std::map<std::string, std::map<std::string, double>>& escenas, unsigned& hilos) {
+        hilos = 0;
+        if (!abrir('{')) return false;
+        while (!cerrar('}')) {
+            std::string clave;
+            if (!cadena(clave) || !abrir(':')) return false;
+            double v;
+            if (clave == "hilos") {
+                if (!numero(v)) return false;
+                hilos = unsigned(v);
+            } else if (clave != "escenas") {
+                if (!saltarValor()) return false;
+            } else {
+                if (!abrir('{')) return false;
+                while (!cerrar('}')) {
+                    std::string nombre;
+                    if (!cadena(nombre) || !abrir(':') || !abrir('{')) return false;
+                    while (!cerrar('}')) {
+                        std::string campo;
+                        double v;
+                        if (!cadena(campo) || !abrir(':')) return false;
+                        if (numero(v)) escenas[nombre][campo] = v;
+                        else if (!saltarValor()) return false;
+                        coma();
+                    }
+                    coma();
+                }
+            }
+            coma();
+        }
+        return true;
+    }
+
+private:
+    const std::string& texto;
+    size_t i = 0;
+
+    void espacios() {
+        while (i < texto.size() && std::isspace(static_cast<unsigned char>(texto[i]))) ++i;
+    }
+    bool abrir(char c) {
+        espacios();
+        if (i < texto.size() && texto[i] == c) {
+            ++i;
+            return true;
+        }
+        return false;
+    }
+    bool cerrar(char c) {
+        espacios();
+        if (i >= texto.size()) return true;
+        if (texto[i] == c) {
+            ++i;
+            return true;
+        }
+        return false;
+    }
+    void coma() { abrir(','); }
+    bool cadena(std::string& s) {
+        if (!abrir('"')) return false;
+        size_t fin = texto.find('"', i);
+        if (fin == std::string::npos) return false;
+        s = texto.substr(i, fin - i);
+        i = fin + 1;
+        return true;
+    }
+    bool numero(double& v) {
+        espacios();
+        const char* inicio = texto.c_str() + i;
+        char* fin;
+        v = std::strtod(inicio, &fin);
+        if (fin == inicio) return false;
+        i += size_t(fin - inicio);
+        return true;
+    }
+    bool saltarValor() {
+        espacios();
+        if (i >= texto.size()) return false;
+        if (texto[i] == '"') {
+            std::string s;
+            return cadena(s);
+        }
+        if (texto[i] == '{' || texto[i] == '[') {
+            int nivel = 0;
+            for (; i < texto.size(); ++i) {
+                if (texto[i] == '{' || texto[i] == '[') ++nivel;
+                if (texto[i] == '}' || texto[i] == ']') --nivel;
+                if (nivel == 0) {
+                    ++i;
+                    return true;
+                }
+            }
+            return false;
+        }
+        while (i < texto.size() && texto[i] != ',' && texto[i] != '}' && texto[i] != ']') ++i;
+        return true;
+    }
+};
+
+bool escribirJson(const std::string& ruta, const std::vector<std::pair<std::string, Resultado>>& resultados, unsigned hilos) {
+    std::ofstream f(ruta);
+    if (!f) {
+        std::cerr << "Error al escribir " << ruta << "\n";
+        return false;
+    }
+    f.precision(6);
+    f << "{\n  \"hilos\": " << hilos << ",\n  \"escenas\": {\n";
+    for (size_t k = 0; k < resultados.size(); ++k) {
+        const Resultado& r = resultados[k].second;
+        f << "    \"" << resultados[k].first << "\": {"
+          << "\"cuerpos\": " << r.cuerpos
+          << ", \"pasos\": " << r.pasos
+          << ", \"segundos\": " << r.segundos
+          << ", \"pasos_por_segundo\": " << r.pasosPorSegundo
+          << ", \"rss_pico_mb\": " << r.rssPicoMb
+          << ", \"error_energia\": " << r.errorEnergia << "}"
+          << (k + 1 < resultados.size() ? "," : "") << "\n";
+    }
+    f << "  }\n}\n";
+    return bool(f);
+}
+
+std::vector<std::string> separar(const std::string& s) {
+    std::vector<std::string> partes;
+    std::stringstream ss(s);
+    std::string parte;
+    while (std::getline(ss, parte, ','))
+        if (!parte.empty()) partes.push_back(parte);
+    return partes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string rutaBase, rutaSalida;
+    double tolerancia = 0.10, toleranciaMemoria = 0.10, toleranciaEnergia = 1.0;
+    unsigned hilos = 0; // 0: los de la base, o todos si no hay base
+    bool actualizar = false;
+    std::vector<std::string> elegidas;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--actualizar") {
+            actualizar = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Falta el valor de " << arg << "\n";
+            return 2;
+        }
+        std::string valor = argv[++i];
+        try {
+            if (arg == "--base") rutaBase = valor;
+            else if (arg == "--salida") rutaSalida = valor;
+            else if (arg == "--tolerancia") tolerancia = std::stod(valor);
+            else if (arg == "--tolerancia-memoria") toleranciaMemoria = std::stod(valor);
+            else if (arg == "--tolerancia-energia") toleranciaEnergia = std::stod(valor);
+            else if (arg == "--escenas") elegidas = separar(valor);
+            else if (arg == "--hilos") hilos = std::max(1u, unsigned(std::stoul(valor)));
+            else {
+                std::cerr << "Opción desconocida: " << arg << "\n";
+                return 2;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Valor no válido para " << arg << ": " << valor << "\n";
+            return 2;
+        }
+    }
+
+    std::map<std::string, std::map<std::string, double>> base;
+    if (!rutaBase.empty() && !actualizar) {
+        std::ifstream f(rutaBase);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        std::string texto = ss.str();
+        unsigned hilosBase = 0;
+        if (!f || !LectorJson(texto).leer(base, hilosBase)) {
+            std::cerr << "Error al leer la base " << rutaBase << "\n";
+            return 2;
+        }
+        // Con otro número de hilos los pasos/s no son comparables (los caminos con hilos
+        // irían más rápidos que la base y taparían regresiones)
+        if (hilosBase > 0 && hilos == 0) hilos = hilosBase;
+        if (hilosBase > 0 && hilos != hilosBase) {
+            std::cerr << "La base " << rutaBase << " se midió con " << hilosBase << " hilos y se piden " << hilos
+                      << ": no se compara (usa --hilos " << hilosBase << " o regenera la base)\n";
+            return 2;
+        }
+    }
+    if (hilos == 0) hilos = hilosDisponibles();
+
+    std::vector<std::pair<std::string, Resultado>> resultados;
+    bool regresion = false;
+    std::printf("%-12s %9s %8s %10s %12s %10s %12s\n", "escena", "cuerpos", "pasos", "segundos", "pasos/s", "RSS MB", "err energía");
+    for (const Escena& esc : ESCENAS) {
+        if (!elegidas.empty() && std::find(elegidas.begin(), elegidas.end(), esc.nombre) == elegidas.end()) continue;
+
+        Resultado r = ejecutarEnHijo(esc, hilos);
+        if (!r.ok) {
+            std::cerr << "Escena " << esc.nombre << ": falló la ejecución\n";
+            regresion = true;
+            continue;
+        }
+        std::printf("%-12s %9llu %8llu %10.3f %12.1f %10.1f %12.3g\n", esc.nombre, (unsigned long long)r.cuerpos,
+                    (unsigned long long)r.pasos, r.segundos, r.pasosPorSegundo, r.rssPicoMb, r.errorEnergia);
+        resultados.emplace_back(esc.nombre, r);
+
+        auto b = base.find(esc.nombre);
+        if (b == base.end()) continue;
+        std::map<std::string, double>& ref = b->second;
+        if (ref.count("pasos_por_segundo") && r.pasosPorSegundo < ref["pasos_por_segundo"] * (1.0 - tolerancia)) {
+            std::printf("  REGRESIÓN: %.1f pasos/s, la base es %.1f (%.1f%% más lento)\n", r.pasosPorSegundo,
+                        ref["pasos_por_segundo"], 100.0 * (1.0 - r.pasosPorSegundo / ref["pasos_por_segundo"]));
+            regresion = true;
+        }
+        if (ref.count("rss_pico_mb") && r.rssPicoMb > ref["rss_pico_mb"] * (1.0 + toleranciaMemoria)) {
+            std::printf("  REGRESIÓN: %.1f MB de memoria pico, la base es %.1f\n", r.rssPicoMb, ref["rss_pico_mb"]);
+            regresion = true;
+        }
+        if (ref.count("error_energia") && r.errorEnergia > ref["error_energia"] * (1.0 + toleranciaEnergia) + 1e-14) {
+            std::printf("  REGRESIÓN: error de energía %.3g, la base es %.3g\n", r.errorEnergia, ref["error_energia"]);
+            regresion = true;
+        }
+    }
+
+    if (!rutaSalida.empty()) escribirJson(rutaSalida, resultados, hilos);
+    if (actualizar) {
+        if (rutaBase.empty()) {
+            std::cerr << "--actualizar necesita --base\n";
+            return 2;
+        }
+        return escribirJson(rutaBase, resultados, hilos) ? 0 : 2;
+    }
+    if (regresion) {
+        std::printf("Hay regresiones respecto a %s\n", rutaBase.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <gravedad/perfilador.hpp>
+#include <gravedad/snapshot.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// ESTADÍSTICAS DE LOS CHECKPOINTS
+struct EstadisticasCheckpoint {
+    uint64_t escritos = 0;
+    uint64_t omitidos = 0;          // pedidos mientras el anterior aún se escribía
+    uint64_t fallidos = 0;
+    double msCopiaUltima = 0.0;     // coste en el bucle de pasos (copia del estado)
+    double msCopiaTotal = 0.0;
+    double msEscrituraUltima = 0.0; // coste en el hilo de fondo
+};
+
+// ESCRITOR DE CHECKPOINTS EN SEGUNDO PLANO
+// solicitar() copia el estado (un memcpy por columna) y vuelve; un hilo aparte lo
+// serializa a disco. La copia no es copy-on-write: es O(N) y bloquea el bucle de
+// pasos, pero reutiliza los buffers de la anterior y cuesta ~2 ms con 100k cuerpos
+// y ~25 ms con 1M, frente a un paso O(N²) de segundos. fork() no vale con el
+// contexto GL y los hilos de fondo, y los pasos escriben todas las columnas, así
+// que un doble buffer también copiaría. msCopiaUltima permite vigilarlo. Si la escritura anterior no ha terminado, el checkpoint se
+// omite: el bucle de pasos nunca espera al disco. El archivo se escribe en
+// '<ruta>.tmp' y se renombra, así un corte a mitad no deja un checkpoint roto.
+template <typename P>
+class EscritorCheckpoints {
+public:
+    explicit EscritorCheckpoints(std::string ruta_) : ruta(std::move(ruta_)), hilo([this] { bucle(); }) {}
+
+    ~EscritorCheckpoints() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            salir = true;
+        }
+        cv.notify_one();
+        hilo.join();
+    }
+
+    EscritorCheckpoints(const EscritorCheckpoints&) = delete;
+    EscritorCheckpoints& operator=(const EscritorCheckpoints&) = delete;
+
+    // Devuelve false si se omitió porque el hilo seguía ocupado.
+    bool solicitar(const Particulas<P>& p, const MetadatosSnapshot& meta) {
+        std::unique_lock<std::mutex> lock(m);
+        if (ocupado) {
+            stats.omitidos++;
+            return false;
+        }
+
+        // El hilo está parado: la copia es nuestra hasta que lo despertemos
+        auto t0 = std::chrono::steady_clock::now();
+        {
+            ZONA("checkpoint copia");
+            copia = p;
+            metaCopia = meta;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        stats.msCopiaUltima = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        stats.msCopiaTotal += stats.msCopiaUltima;
+        ocupado = true;
+        lock.unlock();
+        cv.notify_one();
+        return true;
+    }
+
+    EstadisticasCheckpoint estadisticas() const {
+        std::lock_guard<std::mutex> lock(m);
+        return stats;
+    }
+
+private:
+    std::string ruta;
+    Particulas<P> copia;
+    MetadatosSnapshot metaCopia;
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    bool ocupado = false;
+    bool salir = false;
+    EstadisticasCheckpoint stats;
+    std::thread hilo;
+
+    void bucle() {
+        NOMBRAR_HILO("checkpoints");
+        std::unique_lock<std::mutex> lock(m);
+        while (true) {
+            cv.wait(lock, [this] { return ocupado || salir; });
+            if (!ocupado) return; // salir sin trabajo pendiente
+
+            lock.unlock();
+            auto t0 = std::chrono::steady_clock::now();
+            bool ok;
+            {
+                ZONA("checkpoint escritura");
+                std::string tmp = ruta + ".tmp";
+                ok = guardarSnapshot(copia, tmp, metaCopia) && std::rename(tmp.c_str(), ruta.c_str()) == 0;
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            lock.lock();
+
+            if (ok) stats.escritos++;
+            else stats.fallidos++;
+            stats.msEscrituraUltima = std::chrono::duration<double, std::milli>(t1 - t0).count();
+            ocupado = false;
+        }
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// COLA ACOTADA ENTRE HILOS
+// meter() espera si está llena (contrapresión); sacar() espera si está vacía.
+// Tras cerrar(), sacar() devuelve false cuando ya no queda nada.
+template <typename T>
+class ColaAcotada {
+public:
+    explicit ColaAcotada(size_t capacidad_) : capacidad(capacidad_ ? capacidad_ : 1) {}
+
+    // Devuelve false si la cola está cerrada. 'espero' indica si tuvo que esperar.
+    bool meter(T valor, bool* espero = nullptr) {
+        std::unique_lock<std::mutex> lock(m);
+        if (espero) *espero = elementos.size() >= capacidad;
+        hayHueco.wait(lock, [this] { return elementos.size() < capacidad || cerrada; });
+        if (cerrada) return false;
+        elementos.push_back(std::move(valor));
+        lock.unlock();
+        hayDatos.notify_one();
+        return true;
+    }
+
+    // No espera: false si está llena o cerrada.
+    bool intentarMeter(T valor) {
+        std::unique_lock<std::mutex> lock(m);
+        if (cerrada || elementos.size() >= capacidad) return false;
+        elementos.push_back(std::move(valor));
+        lock.unlock();
+        hayDatos.notify_one();
+        return true;
+    }
+
+    bool sacar(T& valor) {
+        std::unique_lock<std::mutex> lock(m);
+        hayDatos.wait(lock, [this] { return !elementos.empty() || cerrada; });
+        if (elementos.empty()) return false;
+        valor = std::move(elementos.front());
+        elementos.pop_front();
+        lock.unlock();
+        hayHueco.notify_one();
+        return true;
+    }
+
+    // No espera: false si está vacía.
+    bool intentarSacar(T& valor) {
+        std::unique_lock<std::mutex> lock(m);
+        if (elementos.empty()) return false;
+        valor = std::move(elementos.front());
+        elementos.pop_front();
+        lock.unlock();
+        hayHueco.notify_one();
+        return true;
+    }
+
+    void cerrar() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            cerrada = true;
+        }
+        hayDatos.notify_all();
+        hayHueco.notify_all();
+    }
+
+    void vaciar() {
+        std::lock_guard<std::mutex> lock(m);
+        elementos.clear();
+        hayHueco.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m);
+        return elementos.size();
+    }
+
+private:
+    const size_t capacidad;
+    std::deque<T> elementos;
+    mutable std::mutex m;
+    std::condition_variable hayDatos, hayHueco;
+    bool cerrada = false;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// COLUMNA DE DATOS SoA
+// Igual que un std::vector para lo que usa el motor, pero alineada a 64 bytes
+// y capaz de apuntar a memoria ajena (por ejemplo un snapshot mapeado con mmap)
+// sin copiarla. La memoria ajena se mantiene viva con 'propietario'; al crecer
+// por encima de su tamaño la columna pasa a memoria propia.
+template <typename T>
+class Columna {
+    static_assert(std::is_trivially_copyable<T>::value, "Columna solo admite tipos triviales");
+
+public:
+    static constexpr size_t ALINEACION = 64;
+
+    Columna() = default;
+    Columna(const Columna& o) { copiarDe(o); }
+    Columna(Columna&& o) noexcept { robarDe(o); }
+    ~Columna() { liberar(); }
+
+    Columna& operator=(const Columna& o) {
+        if (this != &o) {
+            clear();
+            copiarDe(o);
+        }
+        return *this;
+    }
+
+    Columna& operator=(Columna&& o) noexcept {
+        if (this != &o) {
+            liberar();
+            robarDe(o);
+        }
+        return *this;
+    }
+
+    T* data() { return datos; }
+    const T* data() const { return datos; }
+    size_t size() const { return n; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return n == 0; }
+
+    T& operator[](size_t i) { return datos[i]; }
+    const T& operator[](size_t i) const { return datos[i]; }
+    T& back() { return datos[n - 1]; }
+    const T& back() const { return datos[n - 1]; }
+
+    T* begin() { return datos; }
+    T* end() { return datos + n; }
+    const T* begin() const { return datos; }
+    const T* end() const { return datos + n; }
+
+    void push_back(const T& v) {
+        if (n == cap) reubicar(cap ? cap * 2 : 16);
+        datos[n++] = v;
+    }
+
+    void pop_back() { --n; }
+    void clear() { n = 0; }
+
+    void reserve(size_t c) {
+        if (c > cap) reubicar(c);
+    }
+
+    void resize(size_t m, const T& v = T()) {
+        reserve(m);
+        for (size_t i = n; i < m; ++i) datos[i] = v;
+        n = m;
+    }
+
+    void assign(size_t m, const T& v) {
+        n = 0;
+        resize(m, v);
+    }
+
+    // Usa 'externos' como almacenamiento sin copiarlo. 'propietario' mantiene viva la memoria.
+    void adoptar(T* externos, size_t m, std::shared_ptr<void> propietario) {
+        liberar();
+        datos = externos;
+        n = cap = m;
+        externa = std::move(propietario);
+    }
+
+    bool esExterna() const { return externa != nullptr; }
+
+private:
+    T* datos = nullptr;
+    size_t n = 0;
+    size_t cap = 0;
+    std::shared_ptr<void> externa; // no nulo si 'datos' no es nuestro
+
+    void reubicar(size_t c) {
+        T* nuevo = static_cast<T*>(::operator new(c * sizeof(T), std::align_val_t(ALINEACION)));
+        if (n) std::memcpy(nuevo, datos, n * sizeof(T));
+        size_t m = n;
+        liberar();
+        datos = nuevo;
+        n = m;
+        cap = c;
+    }
+
+    void liberar() {
+        if (externa) externa.reset();
+        else if (datos) ::operator delete(datos, std::align_val_t(ALINEACION));
+        datos = nullptr;
+        n = cap = 0;
+    }
+
+    void copiarDe(const Columna& o) {
+        reserve(o.n);
+        if (o.n) std::memcpy(datos, o.datos, o.n * sizeof(T));
+        n = o.n;
+    }
+
+    void robarDe(Columna& o) {
+        datos = o.datos;
+        n = o.n;
+        cap = o.cap;
+        externa = std::move(o.externa);
+        o.datos = nullptr;
+        o.n = o.cap = 0;
+    }
+};
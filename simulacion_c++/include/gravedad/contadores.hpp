@@ -0,0 +1,80 @@
+#pragma once
+
+#include <gravedad/perfilador.hpp>
+
+#include <cstdint>
+#include <string>
+
+// CONTADORES DE RENDIMIENTO DEL HARDWARE (Linux, perf_event_open)
+// iniciarContadores() abre los grupos de contadores en el hilo que llama; con 'inherit'
+// también cuentan los hilos que cree después (los de paraleloEnBloques), que se suman
+// al terminar, antes de que acabe la zona. ZONA_CONTADA("nombre") es una ZONA que además
+// acumula la diferencia de contadores entre la entrada y la salida. Solo cuenta en el hilo
+// que abrió los contadores.
+// Los FLOPs salen de FP_ARITH_INST_RETIRED (solo Intel), ponderados por el ancho del vector.
+// Lo que el kernel o la CPU no ofrecen (máquinas virtuales, perf_event_paranoid alto) se
+// marca como no disponible y se omite del informe.
+
+enum ContadorHw : uint8_t {
+    CONT_CICLOS,
+    CONT_INSTRUCCIONES,
+    CONT_REFS_CACHE,
+    CONT_FALLOS_CACHE,
+    CONT_RAMAS,
+    CONT_FALLOS_RAMA,
+    CONT_FLOPS,
+    CONT_TAREA_NS,      // task-clock (software, siempre disponible)
+    CONT_FALLOS_PAGINA, // software
+    NUM_CONTADORES
+};
+
+extern const char* const NOMBRES_CONTADORES[NUM_CONTADORES];
+
+struct LecturaContadores {
+    uint64_t valor[NUM_CONTADORES] = {};
+};
+
+// Abre los contadores y empieza a acumular por zona. 'rutaJson' recibe el informe al
+// terminar; se guarda el detalle de un paso de cada 'pasosPorMuestra'.
+bool iniciarContadores(const std::string& rutaJson, uint64_t pasosPorMuestra);
+
+// Marca el final del paso 'paso' (los contadores de las zonas desde la llamada anterior)
+void cerrarPasoContadores(uint64_t paso);
+
+// Imprime el resumen por zona, escribe el JSON y cierra los contadores
+void terminarContadores();
+
+bool contadoresActivos();
+bool contadorDisponible(ContadorHw c);
+void leerContadores(LecturaContadores& l);
+void acumularZonaContadores(const char* nombre, const LecturaContadores& inicio, const LecturaContadores& fin);
+
+// ZONA CON CONTADORES
+class ZonaContadores {
+public:
+    explicit ZonaContadores(const char* nombre_) : nombre(nombre_), activa(contadoresActivos()) {
+        if (activa) leerContadores(inicio);
+    }
+    ~ZonaContadores() {
+        if (!activa) return;
+        LecturaContadores fin;
+        leerContadores(fin);
+        acumularZonaContadores(nombre, inicio, fin);
+    }
+
+    ZonaContadores(const ZonaContadores&) = delete;
+    ZonaContadores& operator=(const ZonaContadores&) = delete;
+
+private:
+    const char* nombre;
+    bool activa;
+    LecturaContadores inicio;
+};
+
+#ifdef GRAVEDAD_PERFILADOR
+#define ZONA_CONTADA(nombre) \
+    ZONA(nombre);            \
+    ZonaContadores GRAVEDAD_CONCATENAR(zonaContadores_, __LINE__)(nombre)
+#else
+#define ZONA_CONTADA(nombre) ((void)0)
+#endif
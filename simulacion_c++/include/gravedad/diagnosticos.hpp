@@ -0,0 +1,77 @@
+#pragma once
+
+#include <gravedad/fuerzas.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// MAGNITUDES CONSERVADAS DE UN INSTANTE
+// Solo cuentan los cuerpos masivos: las partículas de prueba no ejercen fuerza, así
+// que ni su energía ni su momento se conservan en el total.
+struct Diagnostico {
+    double cinetica = 0.0;
+    double potencial = 0.0;
+    double energia = 0.0;
+    double px = 0.0, py = 0.0, pz = 0.0;   // momento lineal
+    double lx = 0.0, ly = 0.0, lz = 0.0;   // momento angular respecto al origen
+    double virial = 0.0;                   // 2K / |W| (1 en equilibrio)
+};
+
+// MEDIR A PARTIR DEL ÚLTIMO CÁLCULO DE FUERZAS
+// Recorrido O(N): el potencial ya viene de calcularAceleraciones con
+// a.calcularPotencial = true. x, y, z deben ser las posiciones en las que se
+// calcularon las fuerzas: xPos para Euler (antes de actualizarPosiciones) y
+// xPrev para Verlet (gravedadVerlet deja ahí la posición del instante de vx).
+template <typename P>
+Diagnostico medirDiagnostico(const Particulas<P>& p, const Aceleraciones<P>& a,
+                             const typename P::Almacen* x, const typename P::Almacen* y,
+                             const typename P::Almacen* z) {
+    Diagnostico d;
+    const bool conPotencial = a.potencial.size() == p.size();
+    for (size_t i = 0; i < p.size(); ++i) {
+        if (p.esPrueba(i)) continue;
+        const double m = double(p.masa[i]);
+        const double vx = double(p.vx[i]), vy = double(p.vy[i]), vz = double(p.vz[i]);
+        const double rx = double(x[i]), ry = double(y[i]), rz = double(z[i]);
+        d.cinetica += 0.5 * m * (vx * vx + vy * vy + vz * vz);
+        if (conPotencial) d.potencial += 0.5 * m * double(a.potencial[i]); // cada par aparece dos veces
+        d.px += m * vx;
+        d.py += m * vy;
+        d.pz += m * vz;
+        d.lx += m * (ry * vz - rz * vy);
+        d.ly += m * (rz * vx - rx * vz);
+        d.lz += m * (rx * vy - ry * vx);
+    }
+    d.energia = d.cinetica + d.potencial;
+    d.virial = d.potencial != 0.0 ? 2.0 * d.cinetica / std::fabs(d.potencial) : 0.0;
+    return d;
+}
+
+// SERIE TEMPORAL DE DIAGNÓSTICOS (CSV)
+// Una fila por medida: paso,tiempo,cinetica,potencial,energia,error_energia,px,py,pz,lx,ly,lz,virial.
+// error_energia es |E - E0| / |E0| respecto a la primera fila.
+class RegistroDiagnosticos {
+public:
+    RegistroDiagnosticos() = default;
+    ~RegistroDiagnosticos() { cerrar(); }
+
+    RegistroDiagnosticos(const RegistroDiagnosticos&) = delete;
+    RegistroDiagnosticos& operator=(const RegistroDiagnosticos&) = delete;
+
+    bool abrir(const std::string& ruta);
+    bool abierto() const { return archivo != nullptr; }
+    void escribir(uint64_t paso, double tiempo, const Diagnostico& d);
+    void cerrar();
+
+    uint64_t filas() const { return numFilas; }
+    double errorEnergiaMax() const { return errorMax; }
+
+private:
+    FILE* archivo = nullptr;
+    std::string ruta;
+    uint64_t numFilas = 0;
+    double energiaInicial = 0.0;
+    double errorMax = 0.0;
+};
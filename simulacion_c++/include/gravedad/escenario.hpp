@@ -0,0 +1,136 @@
+#pragma once
+
+#include <gravedad/paralelo.hpp>
+#include <gravedad/snapshot.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// FORMATOS DE ESCENARIO (condiciones iniciales)
+// CSV: una fila por cuerpo; '#' empieza un comentario. Separadores ',', ';', tabulador o
+//   espacios. Si la primera fila no es numérica es una cabecera con los nombres de las
+//   columnas (x y z vx vy vz radio masa r g b prueba; también valen radius y mass; las
+//   desconocidas se ignoran). Sin cabecera el orden es x,y,z,vx,vy,vz,radio,masa[,r,g,b[,prueba]].
+// Binario: [CabeceraEscenario: 32 bytes] + numCuerpos filas de numColumnas escalares
+//   (f32 o f64, little-endian) en ese mismo orden. Es lo que sale de escribir la cabecera
+//   y después un array de numpy con tofile().
+// Snapshot .grav: se carga con cargarSnapshot.
+// El formato se reconoce por los primeros bytes, no por la extensión.
+
+enum CampoEscenario : uint8_t {
+    CAMPO_X, CAMPO_Y, CAMPO_Z,
+    CAMPO_VX, CAMPO_VY, CAMPO_VZ,
+    CAMPO_RADIO, CAMPO_MASA,
+    CAMPO_R, CAMPO_G, CAMPO_B,
+    CAMPO_PRUEBA,
+    NUM_CAMPOS,
+    CAMPO_IGNORADO = 255
+};
+
+constexpr char MAGIA_ESCENARIO[8] = {'G', 'R', 'A', 'V', 'E', 'S', 'C', 'N'};
+constexpr uint32_t VERSION_ESCENARIO = 1;
+
+struct CabeceraEscenario {
+    char magia[8];
+    uint32_t version;
+    uint32_t numColumnas;     // 8, 11 o 12
+    uint32_t tipo;            // TipoColumna::F32 o F64
+    uint32_t reservado;
+    uint64_t numCuerpos;
+};
+static_assert(sizeof(CabeceraEscenario) == 32, "cabecera de escenario de 32 bytes");
+
+enum class FormatoEscenario : uint8_t { CSV, BINARIO, SNAPSHOT };
+
+// Valores de las columnas que faltan en el archivo
+constexpr double RADIO_POR_DEFECTO = 0.02;
+
+// COLUMNAS DE DESTINO
+// Punteros a columnas ya dimensionadas; se rellenan sin copias intermedias.
+template <typename T>
+struct DestinoEscenario {
+    T* campo[CAMPO_MASA + 1];   // x, y, z, vx, vy, vz, radio, masa
+    Color* color;
+    uint8_t* flags;
+};
+
+// ARCHIVO DE ESCENARIO MAPEADO
+// abrir() mapea el archivo, reconoce el formato y cuenta las filas (en paralelo para CSV);
+// rellenar() parsea o convierte cada bloque de filas en un hilo distinto.
+class ArchivoEscenario {
+public:
+    ~ArchivoEscenario() { cerrar(); }
+
+    bool abrir(const std::string& ruta, unsigned hilos = hilosDisponibles());
+    void cerrar();
+
+    FormatoEscenario formato() const { return fmt; }
+    size_t numCuerpos() const { return filas; }
+
+    template <typename T>
+    bool rellenar(const DestinoEscenario<T>& destino) const;
+
+private:
+    std::string ruta;
+    const char* base = nullptr;
+    size_t bytes = 0;
+    FormatoEscenario fmt = FormatoEscenario::CSV;
+    unsigned hilos = 1;
+    size_t filas = 0;
+
+    // CSV
+    uint8_t campos[64];             // campo de cada columna del archivo
+    size_t numColumnas = 0;
+    size_t lineaDatos = 0;          // número de línea (desde 1) donde empiezan los datos
+    std::vector<size_t> cortes;     // inicio de cada bloque (y el final)
+    std::vector<size_t> filasAntes; // filas de datos antes de cada bloque
+    std::vector<size_t> lineasAntes;
+
+    // Binario
+    CabeceraEscenario cabecera{};
+
+    bool analizarCsv();
+    bool analizarBinario();
+};
+
+extern template bool ArchivoEscenario::rellenar<float>(const DestinoEscenario<float>&) const;
+extern template bool ArchivoEscenario::rellenar<double>(const DestinoEscenario<double>&) const;
+extern template bool ArchivoEscenario::rellenar<long double>(const DestinoEscenario<long double>&) const;
+
+// CARGAR UN ESCENARIO EN PARTÍCULAS
+// Sustituye el contenido de p. La posición anterior queda igual a la actual
+// (para Verlet, ver prepararVerlet en integradores.hpp).
+template <typename P>
+bool cargarEscenario(const std::string& ruta, Particulas<P>& p, unsigned hilos = hilosDisponibles()) {
+    ArchivoEscenario archivo;
+    if (!archivo.abrir(ruta, hilos)) return false;
+    if (archivo.formato() == FormatoEscenario::SNAPSHOT) {
+        archivo.cerrar();
+        return cargarSnapshot(ruta, p);
+    }
+
+    const size_t n = archivo.numCuerpos();
+    p.limpiar();
+    p.paraCadaColumna([n](const char*, auto& col) { col.resize(n); });
+
+    DestinoEscenario<typename P::Almacen> destino{
+        {p.xPos.data(), p.yPos.data(), p.zPos.data(), p.vx.data(), p.vy.data(), p.vz.data(),
+         p.radius.data(), p.masa.data()},
+        p.color.data(), p.flags.data()};
+    if (!archivo.rellenar(destino)) {
+        p.limpiar();
+        return false;
+    }
+
+    paraleloEnBloques(n, hilos, [&p](size_t inicio, size_t fin, unsigned) {
+        for (size_t i = inicio; i < fin; ++i) {
+            p.xPrev[i] = p.xPos[i];
+            p.yPrev[i] = p.yPos[i];
+            p.zPrev[i] = p.zPos[i];
+        }
+    });
+    p.reconstruirIds();
+    return true;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <gravedad/contadores.hpp>
+#include <gravedad/paralelo.hpp>
+#include <gravedad/particulas.hpp>
+#include <gravedad/suavizado.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// ACELERACIONES DE UN PASO
+// Se guardan en P::Calculo. Si es menor que P::Almacen (modo mixto), las
+// posiciones se copian aquí relativas a un origen local, de modo que float
+// conserva precisión cerca de los cuerpos.
+template <typename P>
+struct Aceleraciones {
+    using TCalculo = typename P::Calculo;
+
+    std::vector<TCalculo> ax, ay, az;
+
+    // Copia local de posiciones y masas (solo en modo mixto)
+    std::vector<TCalculo> xLocal, yLocal, zLocal, masaLocal;
+
+    // Fuentes compactadas cuando hay partículas de prueba
+    std::vector<TCalculo> xFuente, yFuente, zFuente, masaFuente;
+
+    // Hilos para el cálculo de fuerzas (ver calcularAceleraciones)
+    unsigned hilos = 1;
+
+    // Con calcularPotencial el mismo recorrido de pares deja en 'potencial' el potencial
+    // gravitatorio de cada cuerpo por unidad de masa (el que crean los masivos).
+    // Solo hace falta en los pasos que se miden (ver diagnosticos.hpp).
+    bool calcularPotencial = false;
+    std::vector<TCalculo> potencial;
+
+    void preparar(size_t n) {
+        ax.assign(n, TCalculo(0));
+        ay.assign(n, TCalculo(0));
+        az.assign(n, TCalculo(0));
+        if (calcularPotencial) potencial.assign(n, TCalculo(0));
+        else potencial.clear();
+    }
+};
+
+// KERNEL DE PARES SIMÉTRICO
+// Recorre cada par una vez y acumula a_i += G m_j d k(r) y a_j -= G m_i d k(r),
+// con k = S::inversoCubo (ver suavizado.hpp). Con POTENCIAL también
+// phi_i -= G m_j S::potencial(r) en el mismo bucle.
+template <bool POTENCIAL = false, typename T, typename S>
+void acumularAceleraciones(const T* __restrict x, const T* __restrict y, const T* __restrict z,
+                           const T* __restrict masa, size_t n, T G, const S& suavizado,
+                           T* __restrict ax, T* __restrict ay, T* __restrict az, T* __restrict pot = nullptr) {
+    for (size_t i = 0; i < n; ++i) {
+        T axi = 0, ayi = 0, azi = 0, poti = 0;
+        for (size_t j = i + 1; j < n; ++j) {
+            T dx = x[j] - x[i];
+            T dy = y[j] - y[i];
+            T dz = z[j] - z[i];
+            T distSq = dx * dx + dy * dy + dz * dz;
+            T s = G * suavizado.inversoCubo(distSq);
+
+            axi += s * masa[j] * dx;
+            ayi += s * masa[j] * dy;
+            azi += s * masa[j] * dz;
+
+            ax[j] -= s * masa[i] * dx;
+            ay[j] -= s * masa[i] * dy;
+            az[j] -= s * masa[i] * dz;
+
+            if constexpr (POTENCIAL) {
+                T phi = G * suavizado.potencial(distSq);
+                poti -= phi * masa[j];
+                pot[j] -= phi * masa[i];
+            }
+        }
+        ax[i] += axi;
+        ay[i] += ayi;
+        az[i] += azi;
+        if constexpr (POTENCIAL) pot[i] += poti;
+    }
+}
+
+// KERNEL FUENTES -> SUMIDEROS (pocas fuentes, muchos sumideros)
+// Cada sumidero recibe la atracción de todas las fuentes; las fuentes no reciben
+// nada de vuelta desde aquí. Se recorre en bloques de sumideros que caben en L1 y
+// el bucle interno va sobre sumideros contiguos, así se vectoriza a lo ancho de
+// ellos. Si una fuente también es sumidero su auto-interacción vale 0 (d = 0);
+// en el potencial no, así que con POTENCIAL se descuenta (ver calcularAceleraciones).
+template <bool POTENCIAL = false, typename T, typename S>
+void acumularDesdeFuentes(const T* __restrict xf, const T* __restrict yf, const T* __restrict zf,
+                          const T* __restrict mf, size_t nFuentes,
+                          const T* __restrict x, const T* __restrict y, const T* __restrict z, size_t n,
+                          T G, const S& suavizado,
+                          T* __restrict ax, T* __restrict ay, T* __restrict az, T* __restrict pot = nullptr) {
+    const size_t BLOQUE = 512;
+    for (size_t inicio = 0; inicio < n; inicio += BLOQUE) {
+        const size_t fin = inicio + BLOQUE < n ? inicio + BLOQUE : n;
+        for (size_t f = 0; f < nFuentes; ++f) {
+            const T xs = xf[f], ys = yf[f], zs = zf[f];
+            const T gm = G * mf[f];
+            for (size_t i = inicio; i < fin; ++i) {
+                T dx = xs - x[i];
+                T dy = ys - y[i];
+                T dz = zs - z[i];
+                T r2 = dx * dx + dy * dy + dz * dz;
+                T s = gm * suavizado.inversoCubo(r2);
+                ax[i] += s * dx;
+                ay[i] += s * dy;
+                az[i] += s * dz;
+                if constexpr (POTENCIAL) pot[i] -= gm * suavizado.potencial(r2);
+            }
+        }
+    }
+}
+
+namespace detalle_fuerzas {
+
+// ELEGIR KERNEL Y REPARTO ENTRE HILOS
+// En paralelo cada hilo toma un bloque de sumideros contra todas las fuentes: sin
+// escrituras compartidas, pero el doble de interacciones que el kernel simétrico
+// cuando todos los cuerpos son fuentes: en ese caso solo se reparte con 3 hilos o más.
+template <bool POTENCIAL, typename P, typename S>
+void acumular(const Particulas<P>& p, const typename P::Calculo* x, const typename P::Calculo* y,
+              const typename P::Calculo* z, const typename P::Calculo* masa, typename P::Calculo G,
+              const S& suavizado, Aceleraciones<P>& a) {
+    using TCalculo = typename P::Calculo;
+    const size_t n = p.size();
+    TCalculo* ax = a.ax.data();
+    TCalculo* ay = a.ay.data();
+    TCalculo* az = a.az.data();
+    TCalculo* pot = POTENCIAL ? a.potencial.data() : nullptr;
+
+    const size_t MIN_CUERPOS_POR_HILO = 1024;
+    const unsigned MIN_HILOS_SIMETRICO = 3; // con 2, n² a medias es más lento que n(n-1)/2 en uno
+    unsigned hilos = unsigned(std::min<size_t>(a.hilos, n / MIN_CUERPOS_POR_HILO));
+    if (a.masaFuente.size() == n && hilos < MIN_HILOS_SIMETRICO) hilos = 1;
+    if (hilos <= 1 && a.masaFuente.size() == n) {
+        acumularAceleraciones<POTENCIAL>(x, y, z, masa, n, G, suavizado, ax, ay, az, pot);
+        return;
+    }
+    if (hilos > 1) {
+        paraleloEnBloques(n, hilos, [&](size_t inicio, size_t fin, unsigned) {
+            ZONA("fuerzas bloque");
+            acumularDesdeFuentes<POTENCIAL>(a.xFuente.data(), a.yFuente.data(), a.zFuente.data(), a.masaFuente.data(),
+                                            a.masaFuente.size(), x + inicio, y + inicio, z + inicio, fin - inicio,
+                                            G, suavizado, ax + inicio, ay + inicio, az + inicio,
+                                            POTENCIAL ? pot + inicio : nullptr);
+        });
+    } else {
+        acumularDesdeFuentes<POTENCIAL>(a.xFuente.data(), a.yFuente.data(), a.zFuente.data(), a.masaFuente.data(),
+                                        a.masaFuente.size(), x, y, z, n, G, suavizado, ax, ay, az, pot);
+    }
+
+    // Las fuentes que también son sumideros se han sumado su propio potencial en r = 0
+    if constexpr (POTENCIAL) {
+        const TCalculo propio = G * suavizado.potencial(TCalculo(0));
+        for (size_t i = 0; i < n; ++i)
+            if (!p.esPrueba(i)) pot[i] += propio * masa[i];
+    }
+}
+
+} // namespace detalle_fuerzas
+
+// FUNCIÓN PARA CALCULAR LAS ACELERACIONES DE TODOS LOS OBJETOS EN UN INSTANTE DE TIEMPO
+template <typename P, typename S>
+void calcularAceleraciones(const Particulas<P>& p, typename P::Calculo G, const S& suavizado,
+                           Aceleraciones<P>& a) {
+    using TAlmacen = typename P::Almacen;
+    using TCalculo = typename P::Calculo;
+    ZONA_CONTADA("fuerzas");
+    const size_t n = p.size();
+    a.preparar(n);
+
+    const TCalculo* x;
+    const TCalculo* y;
+    const TCalculo* z;
+    const TCalculo* masa;
+    if constexpr (std::is_same<TAlmacen, TCalculo>::value) {
+        x = p.xPos.data();
+        y = p.yPos.data();
+        z = p.zPos.data();
+        masa = p.masa.data();
+    } else {
+        // Origen local: centro de masas en la precisión de almacenamiento
+        typename P::Vector o = centroDeMasas(p);
+
+        a.xLocal.resize(n);
+        a.yLocal.resize(n);
+        a.zLocal.resize(n);
+        a.masaLocal.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            a.xLocal[i] = static_cast<TCalculo>(p.xPos[i] - o.x);
+            a.yLocal[i] = static_cast<TCalculo>(p.yPos[i] - o.y);
+            a.zLocal[i] = static_cast<TCalculo>(p.zPos[i] - o.z);
+            a.masaLocal[i] = static_cast<TCalculo>(p.masa[i]);
+        }
+        x = a.xLocal.data();
+        y = a.yLocal.data();
+        z = a.zLocal.data();
+        masa = a.masaLocal.data();
+    }
+
+    // Con partículas de prueba solo actúan como fuente los cuerpos masivos: O(N_fuentes × N)
+    a.xFuente.clear();
+    a.yFuente.clear();
+    a.zFuente.clear();
+    a.masaFuente.clear();
+    for (size_t i = 0; i < n; ++i) {
+        if (!p.esPrueba(i)) {
+            a.xFuente.push_back(x[i]);
+            a.yFuente.push_back(y[i]);
+            a.zFuente.push_back(z[i]);
+            a.masaFuente.push_back(masa[i]);
+        }
+    }
+
+    if (a.calcularPotencial) detalle_fuerzas::acumular<true>(p, x, y, z, masa, G, suavizado, a);
+    else detalle_fuerzas::acumular<false>(p, x, y, z, masa, G, suavizado, a);
+}
+
+// COLISIÓN DE LAS ESFERAS
+template <typename P>
+void Collision(Particulas<P>& p, size_t a, size_t b) {
+    using T = typename P::Almacen;
+    T dx = p.xPos[b] - p.xPos[a];
+    T dy = p.yPos[b] - p.yPos[a];
+    T dz = p.zPos[b] - p.zPos[a];
+    T dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+    T minDist = p.radius[a] + p.radius[b];
+
+    if (dist < minDist && dist > T(0)) {
+        T nx = dx / dist;
+        T ny = dy / dist;
+        T nz = dz / dist;
+
+        T pn = (p.vx[a] * nx + p.vy[a] * ny + p.vz[a] * nz - p.vx[b] * nx - p.vy[b] * ny - p.vz[b] * nz);
+
+        p.vx[a] -= pn * nx;
+        p.vy[a] -= pn * ny;
+        p.vz[a] -= pn * nz;
+        p.vx[b] += pn * nx;
+        p.vy[b] += pn * ny;
+        p.vz[b] += pn * nz;
+
+        T overlap = T(0.5) * (minDist - dist);
+        p.xPos[a] -= overlap * nx;
+        p.yPos[a] -= overlap * ny;
+        p.zPos[a] -= overlap * nz;
+        p.xPos[b] += overlap * nx;
+        p.yPos[b] += overlap * ny;
+        p.zPos[b] += overlap * nz;
+    }
+}
+
+// INSTANCIACIONES EXPLÍCITAS (src/fuerzas.cpp)
+#define GRAVEDAD_FUERZAS_EXTERN_S(P, S) \
+    extern template void calcularAceleraciones<P, S<typename P::Calculo>>(const Particulas<P>&, typename P::Calculo, const S<typename P::Calculo>&, Aceleraciones<P>&);
+#define GRAVEDAD_FUERZAS_EXTERN(P) \
+    GRAVEDAD_FUERZAS_EXTERN_S(P, SuavizadoCorte) \
+    GRAVEDAD_FUERZAS_EXTERN_S(P, SuavizadoPlummer) \
+    GRAVEDAD_FUERZAS_EXTERN_S(P, SuavizadoSpline) \
+    extern template void Collision<P>(Particulas<P>&, size_t, size_t);
+GRAVEDAD_FUERZAS_EXTERN(PrecisionSimple)
+GRAVEDAD_FUERZAS_EXTERN(PrecisionDoble)
+GRAVEDAD_FUERZAS_EXTERN(PrecisionExtendida)
+GRAVEDAD_FUERZAS_EXTERN(PrecisionMixta)
+#undef GRAVEDAD_FUERZAS_EXTERN
+#undef GRAVEDAD_FUERZAS_EXTERN_S
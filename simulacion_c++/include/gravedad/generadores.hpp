@@ -0,0 +1,310 @@
+#pragma once
+
+#include <gravedad/paralelo.hpp>
+#include <gravedad/particulas.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GENERADOR ALEATORIO BASADO EN CONTADOR
+// El número k del cuerpo i es una función pura de (semilla, i, k): da igual qué hilo
+// genere cada cuerpo o en qué orden, con la misma semilla sale la misma escena.
+struct AleatorioContador {
+    uint64_t semilla = 1;
+
+    // Finalizador de SplitMix64
+    static uint64_t mezclar(uint64_t z) {
+        z ^= z >> 30;
+        z *= 0xBF58476D1CE4E5B9ull;
+        z ^= z >> 27;
+        z *= 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return z;
+    }
+
+    uint64_t bits(uint64_t i, uint64_t k) const {
+        return mezclar(mezclar(semilla + i * 0x9E3779B97F4A7C15ull) + (k + 1) * 0xD1B54A32D192ED03ull);
+    }
+
+    // Uniforme en [0, 1)
+    double uniforme(uint64_t i, uint64_t k) const { return double(bits(i, k) >> 11) * 0x1.0p-53; }
+};
+
+// SECUENCIA DE NÚMEROS DE UN CUERPO
+struct FlujoAleatorio {
+    const AleatorioContador& g;
+    uint64_t i;
+    uint64_t k = 0;
+
+    FlujoAleatorio(const AleatorioContador& g_, uint64_t i_) : g(g_), i(i_) {}
+
+    double uniforme() { return g.uniforme(i, k++); }
+
+    // Uniforme en (0, 1]: apto para logaritmos
+    double positivo() { return 1.0 - uniforme(); }
+
+    // Normal estándar (Box-Muller)
+    double normal() {
+        double u = positivo(), v = uniforme();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * M_PI * v);
+    }
+
+    // Dirección isótropa de módulo 'r'
+    void direccion(double r, double& x, double& y, double& z) {
+        double cosT = 2.0 * uniforme() - 1.0;
+        double sinT = std::sqrt(1.0 - cosT * cosT);
+        double fi = 2.0 * M_PI * uniforme();
+        x = r * sinT * std::cos(fi);
+        y = r * sinT * std::sin(fi);
+        z = r * cosT;
+    }
+};
+
+// OPCIONES COMUNES A LOS GENERADORES
+// Los cuerpos se añaden a los que ya haya, así se pueden componer escenas
+// (dos esferas que chocan, un halo con un disco...).
+struct OpcionesGenerador {
+    uint64_t semilla = 1;
+    unsigned hilos = hilosDisponibles();
+    double radioCuerpo = 0.01;              // solo para el render
+    Color color{1.0f, 1.0f, 1.0f};
+    double centro[3] = {0.0, 0.0, 0.0};     // se aplican después de centrar en el
+    double velocidad[3] = {0.0, 0.0, 0.0};  // centro de masas
+};
+
+namespace detalle_generadores {
+
+// Rellena los cuerpos [inicio, inicio+n) en paralelo con f(flujo, x, v) -> masa
+template <typename P, typename F>
+void rellenar(Particulas<P>& p, size_t inicio, size_t n, const OpcionesGenerador& op, F f) {
+    using T = typename P::Almacen;
+    const AleatorioContador g{op.semilla};
+    paraleloEnBloques(n, op.hilos, [&](size_t a, size_t b, unsigned) {
+        for (size_t j = a; j < b; ++j) {
+            FlujoAleatorio flujo(g, j);
+            double x[3] = {0.0, 0.0, 0.0}, v[3] = {0.0, 0.0, 0.0};
+            double m = f(flujo, x, v);
+            const size_t i = inicio + j;
+            p.xPos[i] = p.xPrev[i] = T(x[0]);
+            p.yPos[i] = p.yPrev[i] = T(x[1]);
+            p.zPos[i] = p.zPrev[i] = T(x[2]);
+            p.vx[i] = T(v[0]);
+            p.vy[i] = T(v[1]);
+            p.vz[i] = T(v[2]);
+            p.masa[i] = T(m);
+            p.radius[i] = T(op.radioCuerpo);
+            p.color[i] = op.color;
+            p.flags[i] = m > 0.0 ? 0 : CUERPO_PRUEBA;
+        }
+    });
+}
+
+// Quita la deriva (centro de masas y momento) de [inicio, inicio+n) y aplica centro/velocidad.
+// Las sumas se hacen por bloques fijos, así el resultado no depende del número de hilos.
+template <typename P>
+void centrar(Particulas<P>& p, size_t inicio, size_t n, const OpcionesGenerador& op, bool quitarDeriva) {
+    using T = typename P::Almacen;
+    double d[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (quitarDeriva) {
+        const size_t BLOQUE = 4096;
+        const size_t bloques = (n + BLOQUE - 1) / BLOQUE;
+        std::vector<double> sumas(bloques * 7, 0.0);
+        paraleloEnBloques(bloques, op.hilos, [&](size_t a, size_t b, unsigned) {
+            for (size_t k = a; k < b; ++k) {
+                double* s = &sumas[k * 7];
+                for (size_t i = inicio + k * BLOQUE; i < inicio + std::min(n, (k + 1) * BLOQUE); ++i) {
+                    double m = double(p.masa[i]);
+                    s[0] += m * double(p.xPos[i]);
+                    s[1] += m * double(p.yPos[i]);
+                    s[2] += m * double(p.zPos[i]);
+                    s[3] += m * double(p.vx[i]);
+                    s[4] += m * double(p.vy[i]);
+                    s[5] += m * double(p.vz[i]);
+                    s[6] += m;
+                }
+            }
+        });
+        double total[7] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        for (size_t k = 0; k < bloques; ++k)
+            for (int c = 0; c < 7; ++c) total[c] += sumas[k * 7 + c];
+        if (total[6] > 0.0)
+            for (int c = 0; c < 6; ++c) d[c] = total[c] / total[6];
+    }
+    for (int c = 0; c < 3; ++c) {
+        d[c] -= op.centro[c];
+        d[c + 3] -= op.velocidad[c];
+    }
+
+    paraleloEnBloques(n, op.hilos, [&](size_t a, size_t b, unsigned) {
+        for (size_t i = inicio + a; i < inicio + b; ++i) {
+            p.xPos[i] = p.xPrev[i] = p.xPos[i] - T(d[0]);
+            p.yPos[i] = p.yPrev[i] = p.yPos[i] - T(d[1]);
+            p.zPos[i] = p.zPrev[i] = p.zPos[i] - T(d[2]);
+            p.vx[i] -= T(d[3]);
+            p.vy[i] -= T(d[4]);
+            p.vz[i] -= T(d[5]);
+        }
+    });
+}
+
+} // namespace detalle_generadores
+
+// ESFERA DE PLUMMER (Aarseth, Hénon y Wielen 1974)
+// Masa total M, radio de escala a, en equilibrio virial. Se corta en 10a.
+template <typename P>
+void generarPlummer(Particulas<P>& p, size_t n, double M, double a, double G, const OpcionesGenerador& op = {}) {
+    const size_t inicio = p.ampliar(n);
+    const double m = M / double(n);
+    const double rMax = 10.0 * a;
+    detalle_generadores::rellenar(p, inicio, n, op, [&](FlujoAleatorio& f, double* x, double* v) {
+        double r;
+        do {
+            r = a / std::sqrt(std::pow(f.positivo(), -2.0 / 3.0) - 1.0);
+        } while (!(r < rMax));
+        f.direccion(r, x[0], x[1], x[2]);
+
+        // Módulo de la velocidad por rechazo: g(q) = q²(1-q²)^(7/2), máximo < 0.1
+        double q;
+        do {
+            q = f.uniforme();
+        } while (0.1 * f.uniforme() >= q * q * std::pow(1.0 - q * q, 3.5));
+        const double vEscape = std::sqrt(2.0 * G * M) * std::pow(r * r + a * a, -0.25);
+        f.direccion(q * vEscape, v[0], v[1], v[2]);
+        return m;
+    });
+    detalle_generadores::centrar(p, inicio, n, op, true);
+}
+
+// ESFERA DE HERNQUIST (1990)
+// Densidad ~ 1/(r (r+a)^3), típica de bulbos y halos. Velocidades maxwellianas con la
+// dispersión isótropa de la ecuación de Jeans (Hernquist 1993), limitadas a 0.95 v_escape.
+// Se corta en 30a.
+template <typename P>
+void generarHernquist(Particulas<P>& p, size_t n, double M, double a, double G, const OpcionesGenerador& op = {}) {
+    const size_t inicio = p.ampliar(n);
+    const double m = M / double(n);
+    const double rMax = 30.0 * a;
+    const double sMax = rMax / (rMax + a); // M(<r)/M = (r/(r+a))²
+    detalle_generadores::rellenar(p, inicio, n, op, [&](FlujoAleatorio& f, double* x, double* v) {
+        const double s = std::sqrt(f.uniforme()) * sMax;
+        const double r = a * s / (1.0 - s);
+        f.direccion(r, x[0], x[1], x[2]);
+
+        const double u = r / a;
+        double sigma2 = 0.0;
+        if (u > 0.0) {
+            sigma2 = G * M / (12.0 * a)
+                * (12.0 * u * std::pow(1.0 + u, 3) * std::log((1.0 + u) / u)
+                   - u / (1.0 + u) * (25.0 + 52.0 * u + 42.0 * u * u + 12.0 * u * u * u));
+        }
+        const double sigma = std::sqrt(std::max(sigma2, 0.0));
+        const double vMax = 0.95 * std::sqrt(2.0 * G * M / (r + a));
+        do {
+            v[0] = sigma * f.normal();
+            v[1] = sigma * f.normal();
+            v[2] = sigma * f.normal();
+        } while (v[0] * v[0] + v[1] * v[1] + v[2] * v[2] > vMax * vMax);
+        return m;
+    });
+    detalle_generadores::centrar(p, inicio, n, op, true);
+}
+
+// DISCO EXPONENCIAL EN ÓRBITAS CIRCULARES ALREDEDOR DE UNA MASA CENTRAL
+// Generaliza los satélites v = sqrt(G M / r) de la escena por defecto. Densidad superficial
+// ~ exp(-R/Rd) entre rMin y rMax, en el plano XY con grosor gaussiano 'altura'.
+// Con masaDisco = 0 los cuerpos del disco son partículas de prueba (trazadores).
+// Si masaCentral > 0 se inserta también el cuerpo central.
+struct ParametrosDisco {
+    double masaCentral = 1000.0;
+    double radioCentral = 0.2;  // solo para el render
+    double masaDisco = 0.0;
+    double radioEscala = 0.5;
+    double rMin = 0.3;
+    double rMax = 3.0;
+    double altura = 0.0;
+};
+
+template <typename P>
+void generarDisco(Particulas<P>& p, size_t n, const ParametrosDisco& d, double G, const OpcionesGenerador& op = {}) {
+    using T = typename P::Almacen;
+    if (d.masaCentral > 0.0) {
+        Objeto<P> centro(T(op.centro[0]), T(op.centro[1]), T(op.centro[2]),
+                         T(op.velocidad[0]), T(op.velocidad[1]), T(op.velocidad[2]),
+                         T(d.radioCentral), T(d.masaCentral), Color{1.0f, 0.8f, 0.2f});
+        p.insertar(centro);
+    }
+    const size_t inicio = p.ampliar(n);
+
+    // Masa del disco dentro de R (aproximada como si fuera esférica), normalizada al corte
+    const double Rd = d.radioEscala;
+    auto acumulada = [Rd](double R) { return 1.0 - (1.0 + R / Rd) * std::exp(-R / Rd); };
+    const double cMin = acumulada(d.rMin), cMax = acumulada(d.rMax);
+    const double m = d.masaDisco / double(n);
+
+    detalle_generadores::rellenar(p, inicio, n, op, [&](FlujoAleatorio& f, double* x, double* v) {
+        // R ~ R exp(-R/Rd) es una Gamma(2, Rd): suma de dos exponenciales
+        double R;
+        do {
+            R = -Rd * std::log(f.positivo() * f.positivo());
+        } while (R < d.rMin || R > d.rMax);
+        const double fi = 2.0 * M_PI * f.uniforme();
+        const double c = std::cos(fi), s = std::sin(fi);
+        x[0] = R * c;
+        x[1] = R * s;
+        x[2] = d.altura * f.normal();
+
+        const double encerrada = d.masaCentral + d.masaDisco * (acumulada(R) - cMin) / (cMax - cMin);
+        const double vc = std::sqrt(G * encerrada / R);
+        v[0] = -vc * s;
+        v[1] = vc * c;
+        return m;
+    });
+    // El disco ya está centrado en la masa central: solo se desplaza
+    detalle_generadores::centrar(p, inicio, n, op, false);
+}
+
+// CAJA UNIFORME
+// n cuerpos de masa M/n repartidos uniformemente en un cubo de lado 'lado' centrado,
+// con velocidades gaussianas de dispersión 'sigma' por componente (0: colapso en frío).
+template <typename P>
+void generarCaja(Particulas<P>& p, size_t n, double M, double lado, double sigma, const OpcionesGenerador& op = {}) {
+    const size_t inicio = p.ampliar(n);
+    const double m = M / double(n);
+    detalle_generadores::rellenar(p, inicio, n, op, [&](FlujoAleatorio& f, double* x, double* v) {
+        for (int c = 0; c < 3; ++c) x[c] = (f.uniforme() - 0.5) * lado;
+        if (sigma > 0.0)
+            for (int c = 0; c < 3; ++c) v[c] = sigma * f.normal();
+        return m;
+    });
+    detalle_generadores::centrar(p, inicio, n, op, true);
+}
+
+// ESCENAS PREDEFINIDAS PARA LOS VISORES (--generar)
+// Escaladas a la ventana por defecto (cámara a 3 unidades). Devuelve false si el nombre no existe.
+template <typename P>
+bool generarEscena(const std::string& nombre, size_t n, uint64_t semilla, double G, Particulas<P>& p) {
+    OpcionesGenerador op;
+    op.semilla = semilla;
+    p.limpiar();
+    p.reservar(n + 1);
+    if (nombre == "plummer") {
+        generarPlummer(p, n, 1000.0, 0.3, G, op);
+    } else if (nombre == "hernquist") {
+        generarHernquist(p, n, 1000.0, 0.2, G, op);
+    } else if (nombre == "disco") {
+        ParametrosDisco d;
+        d.altura = 0.01;
+        op.color = Color{0.6f, 0.8f, 1.0f};
+        generarDisco(p, n, d, G, op);
+    } else if (nombre == "caja") {
+        generarCaja(p, n, 1000.0, 1.5, 0.0, op);
+    } else {
+        std::cerr << "Escena desconocida: " << nombre << " (plummer, hernquist, disco, caja)\n";
+        return false;
+    }
+    return true;
+}
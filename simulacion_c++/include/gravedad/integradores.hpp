@@ -0,0 +1,97 @@
+#pragma once
+
+#include <gravedad/fuerzas.hpp>
+
+#include <cstddef>
+
+// ATRACCIÓN ENTRE LAS ESFERAS (Euler semi-implícito: primero velocidades)
+template <typename P, typename S>
+void gravedadMutua(Particulas<P>& p, typename P::Calculo G, const S& suavizado,
+                   typename P::Almacen dt, Aceleraciones<P>& a) {
+    using T = typename P::Almacen;
+    calcularAceleraciones(p, G, suavizado, a);
+    ZONA_CONTADA("integrar velocidades");
+    for (size_t i = 0; i < p.size(); ++i) {
+        p.vx[i] += static_cast<T>(a.ax[i]) * dt;
+        p.vy[i] += static_cast<T>(a.ay[i]) * dt;
+        p.vz[i] += static_cast<T>(a.az[i]) * dt;
+    }
+}
+
+// AVANZAR POSICIONES CON LA VELOCIDAD ACTUAL
+template <typename P>
+void actualizarPosiciones(Particulas<P>& p, typename P::Almacen dt) {
+    ZONA_CONTADA("actualizar posiciones");
+    for (size_t i = 0; i < p.size(); ++i) {
+        p.xPos[i] += p.vx[i] * dt;
+        p.yPos[i] += p.vy[i] * dt;
+        p.zPos[i] += p.vz[i] * dt;
+    }
+}
+
+// INSERTAR UN CUERPO PARA VERLET: la posición anterior sale de la velocidad inicial
+template <typename P>
+IdCuerpo insertarVerlet(Particulas<P>& p, const Objeto<P>& o, typename P::Almacen dt) {
+    IdCuerpo id = p.insertar(o);
+    size_t i = p.indiceDe(id);
+    p.xPrev[i] = o.xPos - o.vx * dt;
+    p.yPrev[i] = o.yPos - o.vy * dt;
+    p.zPrev[i] = o.zPos - o.vz * dt;
+    return id;
+}
+
+// PREPARAR PARA VERLET CUERPOS YA CARGADOS (escenarios): igual que insertarVerlet
+template <typename P>
+void prepararVerlet(Particulas<P>& p, typename P::Almacen dt) {
+    for (size_t i = 0; i < p.size(); ++i) {
+        p.xPrev[i] = p.xPos[i] - p.vx[i] * dt;
+        p.yPrev[i] = p.yPos[i] - p.vy[i] * dt;
+        p.zPrev[i] = p.zPos[i] - p.vz[i] * dt;
+    }
+}
+
+// FUNCIÓN PRINCIPAL DE ACTUALIZACIÓN DEL MÉTODO DE VERLET
+// Además deja en vx/vy/vz la velocidad en el instante de las fuerzas (diferencia central).
+template <typename P, typename S>
+void gravedadVerlet(Particulas<P>& p, typename P::Calculo G, const S& suavizado,
+                    typename P::Almacen dt, Aceleraciones<P>& a) {
+    using T = typename P::Almacen;
+    calcularAceleraciones(p, G, suavizado, a);
+
+    ZONA_CONTADA("integrar Verlet");
+    const T dt2 = dt * dt;
+    const T inv2dt = T(1) / (T(2) * dt);
+    for (size_t i = 0; i < p.size(); ++i) {
+        T tempX = p.xPos[i];
+        T tempY = p.yPos[i];
+        T tempZ = p.zPos[i];
+
+        p.xPos[i] = T(2) * p.xPos[i] - p.xPrev[i] + static_cast<T>(a.ax[i]) * dt2;
+        p.yPos[i] = T(2) * p.yPos[i] - p.yPrev[i] + static_cast<T>(a.ay[i]) * dt2;
+        p.zPos[i] = T(2) * p.zPos[i] - p.zPrev[i] + static_cast<T>(a.az[i]) * dt2;
+
+        p.vx[i] = (p.xPos[i] - p.xPrev[i]) * inv2dt;
+        p.vy[i] = (p.yPos[i] - p.yPrev[i]) * inv2dt;
+        p.vz[i] = (p.zPos[i] - p.zPrev[i]) * inv2dt;
+
+        p.xPrev[i] = tempX;
+        p.yPrev[i] = tempY;
+        p.zPrev[i] = tempZ;
+    }
+}
+
+// INSTANCIACIONES EXPLÍCITAS (src/fuerzas.cpp)
+#define GRAVEDAD_INTEGRADORES_EXTERN_S(P, S) \
+    extern template void gravedadMutua<P, S<typename P::Calculo>>(Particulas<P>&, typename P::Calculo, const S<typename P::Calculo>&, typename P::Almacen, Aceleraciones<P>&); \
+    extern template void gravedadVerlet<P, S<typename P::Calculo>>(Particulas<P>&, typename P::Calculo, const S<typename P::Calculo>&, typename P::Almacen, Aceleraciones<P>&);
+#define GRAVEDAD_INTEGRADORES_EXTERN(P) \
+    GRAVEDAD_INTEGRADORES_EXTERN_S(P, SuavizadoCorte) \
+    GRAVEDAD_INTEGRADORES_EXTERN_S(P, SuavizadoPlummer) \
+    GRAVEDAD_INTEGRADORES_EXTERN_S(P, SuavizadoSpline) \
+    extern template void actualizarPosiciones<P>(Particulas<P>&, typename P::Almacen);
+GRAVEDAD_INTEGRADORES_EXTERN(PrecisionSimple)
+GRAVEDAD_INTEGRADORES_EXTERN(PrecisionDoble)
+GRAVEDAD_INTEGRADORES_EXTERN(PrecisionExtendida)
+GRAVEDAD_INTEGRADORES_EXTERN(PrecisionMixta)
+#undef GRAVEDAD_INTEGRADORES_EXTERN
+#undef GRAVEDAD_INTEGRADORES_EXTERN_S
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <gravedad/paralelo.hpp>
+#include <gravedad/trayectoria.hpp>
+
+#include <cstdint>
+#include <string>
+
+// CÓMO SE DIBUJAN LOS CUERPOS
+enum class ModoEsferas : uint8_t {
+    MALLA,      // esfera teselada, instanciada
+    IMPOSTORES, // un quad por cuerpo con la esfera trazada en el fragment shader
+};
+
+// OPCIONES DE LÍNEA DE COMANDOS DE LOS SIMULADORES
+// Cada ejecutable rellena sus valores por defecto antes de llamar a leerOpciones.
+struct Opciones {
+    std::string rutaEscenario;      // --escenario <archivo.csv|binario|.grav> (condiciones iniciales)
+    std::string generador;          // --generar plummer|hernquist|disco|caja (en lugar del escenario)
+    size_t cuerposGenerados = 10000; // --cuerpos <n>
+    uint64_t semilla = 1;           // --semilla <s>
+    unsigned hilos = hilosDisponibles(); // --hilos <n> (fuerzas y carga de escenarios)
+    std::string rutaCargar;         // --cargar <snapshot.grav>
+    std::string rutaGuardar;        // --guardar <snapshot.grav>
+    std::string rutaCheckpoint;     // --checkpoint <archivo.grav>
+    uint64_t pasosCheckpoint = 1000; // --checkpoint-cada <pasos>
+    std::string rutaTrayectoria;    // --trayectoria <archivo.tray>
+    uint64_t pasosTrayectoria = 10; // --trayectoria-cada <pasos>
+    OpcionesTrayectoria trayectoria; // --trayectoria-codec crudo|cuantizado|xor, --trayectoria-error <e>
+    double dtFijo = 0.001;          // --paso <dt> (paso fijo de Verlet)
+    unsigned maxSubpasos = 100;     // --subpasos-max <n> (pasos fijos por frame como máximo; lo demás se descarta)
+    std::string rutaReproducir;     // --reproducir <archivo.tray> (no simula, solo reproduce)
+    double framesPorSegundo = 30.0; // --reproducir-fps <frames de trayectoria por segundo>
+    std::string rutaDiagnosticos;   // --diagnosticos <archivo.csv> (energía, momentos y virial)
+    uint64_t pasosDiagnosticos = 100; // --diagnosticos-cada <pasos>
+    std::string rutaTraza;          // --traza <archivo.json> (requiere GRAVEDAD_PERFILADOR)
+    size_t eventosTraza = size_t(1) << 16; // --traza-eventos <n> (por hilo; se guardan los últimos)
+    std::string rutaContadores;     // --contadores <archivo.json> (perf_event_open, requiere GRAVEDAD_PERFILADOR)
+    uint64_t pasosContadores = 10;  // --contadores-cada <pasos> (detalle de un paso de cada N en el JSON)
+    ModoEsferas esferas = ModoEsferas::MALLA; // --esferas malla|impostores
+    size_t longitudEstelas = 0;     // --estelas <muestras por cuerpo> (0 = sin estelas)
+    float radioMinPx = 0.5f;        // --recorte-px <r> (no dibujar cuerpos de radio menor en pantalla; 0 = todos)
+    int anchoSinVentana = 0;        // --sin-ventana <ancho>x<alto> (EGL, sin pantalla; 0 = con ventana)
+    int altoSinVentana = 0;
+    uint64_t maxFrames = 0;         // --frames <n> (termina tras n frames; 0 = hasta cerrar la ventana)
+    std::string rutaCapturas;       // --capturas <patrón printf, p. ej. f%05d.png>
+    std::string rutaVideo;          // --video <archivo.yuv | '|comando'> (yuv420p crudo)
+    double fpsCaptura = 60.0;       // --video-fps <f> (al capturar o sin ventana, cada frame avanza 1/f s)
+};
+
+// Devuelve false si algún argumento no es válido (ya avisado por cerr).
+bool leerOpciones(int argc, char** argv, Opciones& op);
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// HILOS DISPONIBLES (al menos uno)
+inline unsigned hilosDisponibles() {
+    unsigned h = std::thread::hardware_concurrency();
+    return h ? h : 1;
+}
+
+// REPARTIR [0, n) EN BLOQUES CONTIGUOS ENTRE HILOS
+// Llama a f(inicio, fin, bloque) una vez por bloque, en paralelo. El bloque 0 lo
+// ejecuta el hilo que llama. Con n pequeño se usan menos hilos (nunca bloques vacíos).
+template <typename F>
+void paraleloEnBloques(size_t n, unsigned hilos, F&& f) {
+    if (hilos == 0) hilos = 1;
+    if (size_t(hilos) > n) hilos = unsigned(n ? n : 1);
+    if (hilos == 1) {
+        f(size_t(0), n, 0u);
+        return;
+    }
+
+    std::vector<std::thread> trabajadores;
+    trabajadores.reserve(hilos - 1);
+    for (unsigned h = 1; h < hilos; ++h) {
+        size_t inicio = n * h / hilos;
+        size_t fin = n * (h + 1) / hilos;
+        trabajadores.emplace_back([&f, inicio, fin, h] { f(inicio, fin, h); });
+    }
+    f(size_t(0), n / hilos, 0u);
+    for (auto& t : trabajadores) t.join();
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <gravedad/columna.hpp>
+#include <gravedad/pool.hpp>
+#include <gravedad/precision.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// BANDERAS DE UN CUERPO
+enum : uint8_t {
+    CUERPO_PRUEBA = 1 << 0, // partícula de prueba: recibe gravedad pero no la ejerce
+};
+
+// COLOR DE UN CUERPO (solo lo usa el render)
+struct Color {
+    float r, g, b;
+};
+
+// DESCRIPCIÓN DE UN CUERPO
+// Sirve para insertar o leer un cuerpo suelto; el almacenamiento real es SoA.
+template <typename P>
+struct Objeto {
+    using T = typename P::Almacen;
+
+    T xPos, yPos, zPos;
+    T vx, vy, vz;
+    T radius;
+    T masa;
+    Color color;
+    uint8_t flags = 0;
+
+    Objeto(T x, T y, T z, T vx_, T vy_, T vz_, T r, T m, Color c)
+        : xPos(x), yPos(y), zPos(z), vx(vx_), vy(vy_), vz(vz_), radius(r), masa(m), color(c) {}
+};
+
+// PARTÍCULAS EN FORMATO SoA
+// Cada propiedad es una columna densa, así los kernels recorren memoria contigua.
+// Los ids estables los gestiona MapaIds; eliminar mueve el último cuerpo al hueco.
+template <typename P>
+class Particulas {
+public:
+    using T = typename P::Almacen;
+
+    Columna<T> xPos, yPos, zPos;
+    Columna<T> vx, vy, vz;
+    Columna<T> xPrev, yPrev, zPrev; // posición anterior para Verlet
+    Columna<T> radius;
+    Columna<T> masa;
+    Columna<Color> color;
+    Columna<uint8_t> flags;
+
+    IdCuerpo insertar(const Objeto<P>& o) {
+        IdCuerpo id = ids.insertar();
+        xPos.push_back(o.xPos); yPos.push_back(o.yPos); zPos.push_back(o.zPos);
+        vx.push_back(o.vx); vy.push_back(o.vy); vz.push_back(o.vz);
+        xPrev.push_back(o.xPos); yPrev.push_back(o.yPos); zPrev.push_back(o.zPos);
+        radius.push_back(o.radius);
+        masa.push_back(o.masa);
+        color.push_back(o.color);
+        flags.push_back(o.flags);
+        return id;
+    }
+
+    void eliminar(IdCuerpo id) {
+        size_t hueco = ids.eliminar(id);
+        size_t ultimo = xPos.size() - 1;
+        paraCadaColumna([&](const char*, auto& col) {
+            if (hueco != ultimo) col[hueco] = col[ultimo];
+            col.pop_back();
+        });
+    }
+
+    void eliminarEn(size_t i) { eliminar(ids.idDe(i)); }
+
+    Objeto<P> leer(size_t i) const {
+        Objeto<P> o(xPos[i], yPos[i], zPos[i], vx[i], vy[i], vz[i], radius[i], masa[i], color[i]);
+        o.flags = flags[i];
+        return o;
+    }
+
+    // Añade n cuerpos sin inicializar (todo a cero) y devuelve el índice del primero.
+    // Para rellenar las columnas después, por ejemplo desde varios hilos.
+    size_t ampliar(size_t n) {
+        const size_t inicio = xPos.size();
+        ids.reservar(inicio + n);
+        for (size_t i = 0; i < n; ++i) ids.insertar();
+        paraCadaColumna([m = inicio + n](const char*, auto& col) { col.resize(m); });
+        return inicio;
+    }
+
+    bool esPrueba(size_t i) const { return (flags[i] & CUERPO_PRUEBA) != 0; }
+
+    // Tras rellenar las columnas desde fuera (snapshots, cargadores): rehace los ids.
+    // Sin 'indices' los ids son simplemente 0..n-1. false si los ids no son válidos.
+    bool reconstruirIds(const uint32_t* indices = nullptr, const uint32_t* generaciones = nullptr) {
+        return ids.reconstruir(xPos.size(), indices, generaciones);
+    }
+
+    bool contiene(IdCuerpo id) const { return ids.contiene(id); }
+    size_t indiceDe(IdCuerpo id) const { return ids.indiceDenso(id); }
+    IdCuerpo idDe(size_t i) const { return ids.idDe(i); }
+
+    size_t size() const { return xPos.size(); }
+    bool empty() const { return xPos.empty(); }
+
+    void reservar(size_t n) {
+        ids.reservar(n);
+        paraCadaColumna([n](const char*, auto& col) { col.reserve(n); });
+    }
+
+    void limpiar() {
+        ids.limpiar();
+        paraCadaColumna([](const char*, auto& col) { col.clear(); });
+    }
+
+    // Aplica f(nombre, columna) a todas las columnas, siempre en el mismo orden.
+    template <typename F>
+    void paraCadaColumna(F f) { recorrerColumnas(*this, f); }
+    template <typename F>
+    void paraCadaColumna(F f) const { recorrerColumnas(*this, f); }
+
+private:
+    MapaIds ids;
+
+    template <typename Self, typename F>
+    static void recorrerColumnas(Self& s, F& f) {
+        f("xPos", s.xPos); f("yPos", s.yPos); f("zPos", s.zPos);
+        f("vx", s.vx); f("vy", s.vy); f("vz", s.vz);
+        f("xPrev", s.xPrev); f("yPrev", s.yPrev); f("zPrev", s.zPrev);
+        f("radius", s.radius); f("masa", s.masa); f("color", s.color);
+        f("flags", s.flags);
+    }
+};
+
+// ELIMINAR LOS CUERPOS QUE SE HAN ALEJADO DEMASIADO
+template <typename P>
+void eliminarEscapados(Particulas<P>& p, typename P::Almacen radioMax) {
+    // De atrás hacia delante: el último ocupa el hueco y ya fue revisado
+    for (size_t i = p.size(); i-- > 0;) {
+        auto d2 = p.xPos[i] * p.xPos[i] + p.yPos[i] * p.yPos[i] + p.zPos[i] * p.zPos[i];
+        if (d2 > radioMax * radioMax) p.eliminarEn(i);
+    }
+}
+
+// CENTRO DE MASAS
+template <typename P>
+typename P::Vector centroDeMasas(const Particulas<P>& p) {
+    using T = typename P::Almacen;
+    typename P::Vector c;
+    T mTotal = 0;
+    for (size_t i = 0; i < p.size(); ++i) {
+        c += typename P::Vector(p.xPos[i], p.yPos[i], p.zPos[i]) * p.masa[i];
+        mTotal += p.masa[i];
+    }
+    if (mTotal > 0) c *= T(1) / mTotal;
+    return c;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// PERFILADOR POR ZONAS
+// ZONA("nombre") mide desde esa línea hasta el final del bloque. Solo existe si se
+// compila con GRAVEDAD_PERFILADOR (cmake -DGRAVEDAD_PERFILADOR=ON); si no, las macros
+// no generan código. Cada hilo escribe en su propio buffer circular sin locks: al
+// llenarse se pisan los eventos más antiguos. exportarTrazaChrome() vuelca todo en
+// formato trace_event de Chrome (se abre en Perfetto o en chrome://tracing).
+// El nombre de la zona debe ser un literal: se guarda el puntero, no una copia.
+
+#ifdef GRAVEDAD_PERFILADOR
+constexpr bool PERFILADOR_ACTIVO = true;
+#else
+constexpr bool PERFILADOR_ACTIVO = false;
+#endif
+
+struct EventoZona {
+    const char* nombre;
+    uint64_t inicioNs;      // desde que arrancó el perfilador
+    uint64_t duracionNs;
+};
+
+// Nanosegundos desde el arranque (reloj monótono)
+uint64_t relojPerfilador();
+
+// Guarda un evento en el buffer del hilo que llama
+void registrarZona(const char* nombre, uint64_t inicioNs, uint64_t finNs);
+
+// Nombre del carril del hilo en la traza (por defecto "hilo N")
+void nombrarHiloPerfilador(const char* nombre);
+
+// Eventos por hilo de los buffers que se creen a partir de ahora
+void configurarPerfilador(size_t eventosPorHilo);
+
+// Escribe la traza en JSON. Llamar con los hilos ya parados o en reposo.
+bool exportarTrazaChrome(const std::string& ruta);
+
+// Tiempo total, llamadas y media por zona (solo de los eventos que siguen en los buffers)
+void imprimirResumenPerfilador();
+
+// ZONA CON ÁMBITO
+class ZonaPerfilador {
+public:
+    explicit ZonaPerfilador(const char* nombre_) : nombre(nombre_), inicio(relojPerfilador()) {}
+    ~ZonaPerfilador() { registrarZona(nombre, inicio, relojPerfilador()); }
+
+    ZonaPerfilador(const ZonaPerfilador&) = delete;
+    ZonaPerfilador& operator=(const ZonaPerfilador&) = delete;
+
+private:
+    const char* nombre;
+    uint64_t inicio;
+};
+
+#define GRAVEDAD_CONCATENAR_(a, b) a##b
+#define GRAVEDAD_CONCATENAR(a, b) GRAVEDAD_CONCATENAR_(a, b)
+
+#ifdef GRAVEDAD_PERFILADOR
+#define ZONA(nombre) ZonaPerfilador GRAVEDAD_CONCATENAR(zonaPerfilador_, __LINE__)(nombre)
+#define NOMBRAR_HILO(nombre) nombrarHiloPerfilador(nombre)
+#else
+#define ZONA(nombre) ((void)0)
+#define NOMBRAR_HILO(nombre) ((void)0)
+#endif
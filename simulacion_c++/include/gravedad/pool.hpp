@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// IDENTIFICADOR ESTABLE DE UN CUERPO
+// Sigue siendo válido aunque se añadan o eliminen otros cuerpos. Al eliminar un
+// cuerpo su generación cambia, así que un id viejo nunca apunta a un cuerpo nuevo.
+struct IdCuerpo {
+    uint32_t indice = UINT32_MAX;
+    uint32_t generacion = 0;
+
+    bool valido() const { return indice != UINT32_MAX; }
+    bool operator==(const IdCuerpo& o) const { return indice == o.indice && generacion == o.generacion; }
+    bool operator!=(const IdCuerpo& o) const { return !(*this == o); }
+};
+
+// MAPA DE IDS GENERACIONAL (slot map)
+// Traduce ids estables a posiciones densas. Los datos viven aparte en arrays
+// densos; al eliminar, el último elemento denso ocupa el hueco (swap and pop),
+// así que insertar y eliminar son O(1) y los kernels iteran sin huecos.
+class MapaIds {
+public:
+    // El nuevo cuerpo ocupa la posición densa tamano() - 1.
+    IdCuerpo insertar();
+
+    // Devuelve la posición densa liberada. Si no era la última, el llamador
+    // debe mover ahí el último elemento de sus arrays y hacer pop_back.
+    size_t eliminar(IdCuerpo id);
+
+    bool contiene(IdCuerpo id) const;
+    size_t indiceDenso(IdCuerpo id) const { return ranuras[id.indice].denso; }
+    IdCuerpo idDe(size_t denso) const;
+
+    size_t tamano() const { return densoARanura.size(); }
+    void reservar(size_t n);
+    void limpiar();
+
+    // Rehace el mapa para n elementos densos con los ids dados (o 0..n-1 si
+    // 'indices' es nulo). Las ranuras que no aparecen quedan libres y conservan su
+    // generación. Devuelve false (sin tocar el mapa) si hay índices repetidos, NINGUNA
+    // o alguno más allá de maxRanurasPara(n).
+    bool reconstruir(size_t n, const uint32_t* indices, const uint32_t* generaciones);
+
+    // Ranuras que se aceptan de fuera para n cuerpos: las libres vienen de cuerpos
+    // eliminados (fusiones), así que puede haber bastantes más que n, pero no 4G.
+    static size_t maxRanurasPara(size_t n) { return 16 * n + 65536; }
+
+private:
+    static constexpr uint32_t NINGUNA = UINT32_MAX;
+
+    struct Ranura {
+        uint32_t denso = NINGUNA;      // posición en los arrays densos (o siguiente libre)
+        uint32_t generacion = 0;
+    };
+
+    std::vector<Ranura> ranuras;
+    std::vector<uint32_t> densoARanura;
+    uint32_t primeraLibre = NINGUNA;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+// VECTOR 3D MÍNIMO DEL MOTOR
+// El motor no depende de glm; el render convierte a glm::vec3 cuando lo necesita.
+template <typename T>
+struct Vec3 {
+    T x = 0, y = 0, z = 0;
+
+    Vec3() = default;
+    Vec3(T x_, T y_, T z_) : x(x_), y(y_), z(z_) {}
+
+    Vec3& operator+=(const Vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+    Vec3& operator-=(const Vec3& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+    Vec3& operator*=(T s) { x *= s; y *= s; z *= s; return *this; }
+    friend Vec3 operator+(Vec3 a, const Vec3& b) { return a += b; }
+    friend Vec3 operator-(Vec3 a, const Vec3& b) { return a -= b; }
+    friend Vec3 operator*(Vec3 a, T s) { return a *= s; }
+    friend Vec3 operator*(T s, Vec3 a) { return a *= s; }
+};
+
+template <typename T>
+T dot(const Vec3<T>& a, const Vec3<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+template <typename T>
+Vec3<T> cross(const Vec3<T>& a, const Vec3<T>& b) {
+    return Vec3<T>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+// TIPO DE PRECISIÓN DEL MOTOR
+// Almacen: posiciones, velocidades y masas. Calculo: kernels de fuerza.
+// Todo el motor (Particulas, Aceleraciones, integradores) se parametriza con él.
+template <typename TAlmacen, typename TCalculo = TAlmacen>
+struct Precision {
+    using Almacen = TAlmacen;
+    using Calculo = TCalculo;
+    using Vector = Vec3<TAlmacen>;
+};
+
+using PrecisionSimple = Precision<float>;
+using PrecisionDoble = Precision<double>;
+using PrecisionExtendida = Precision<long double>;
+using PrecisionMixta = Precision<double, float>; // double en memoria, float en las fuerzas
+
+// Nombre legible de cada instanciación (benchmarks y logs)
+template <typename P> constexpr const char* nombrePrecision() { return "personalizada"; }
+template <> constexpr const char* nombrePrecision<PrecisionSimple>() { return "simple"; }
+template <> constexpr const char* nombrePrecision<PrecisionDoble>() { return "doble"; }
+template <> constexpr const char* nombrePrecision<PrecisionExtendida>() { return "extendida"; }
+template <> constexpr const char* nombrePrecision<PrecisionMixta>() { return "mixta"; }
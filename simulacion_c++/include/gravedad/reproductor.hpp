@@ -0,0 +1,116 @@
+#pragma once
+
+#include <gravedad/trayectoria.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ESTADÍSTICAS DE LA REPRODUCCIÓN
+struct EstadisticasReproduccion {
+    uint64_t aciertos = 0;      // chunks que ya estaban decodificados al pedirlos
+    uint64_t fallos = 0;        // chunks decodificados en el hilo de render (el prefetch no llegó)
+    uint64_t precargados = 0;   // chunks decodificados por el hilo de fondo
+};
+
+// REPRODUCTOR DE TRAYECTORIAS
+// Lee un .tray mapeado en memoria y devuelve frames interpolados en cualquier
+// posición fraccionaria. Un hilo de fondo decodifica por adelantado los chunks
+// siguientes en el sentido de la reproducción, así el render nunca espera al disco
+// ni a zstd salvo tras un salto largo.
+class ReproductorTrayectoria {
+public:
+    ReproductorTrayectoria() = default;
+    ~ReproductorTrayectoria() { cerrar(); }
+
+    ReproductorTrayectoria(const ReproductorTrayectoria&) = delete;
+    ReproductorTrayectoria& operator=(const ReproductorTrayectoria&) = delete;
+
+    bool abrir(const std::string& ruta);
+    void cerrar();
+
+    uint64_t numFrames() const { return lector.numFrames(); }
+
+    // Frame en 'posicion' (en frames, se recorta a [0, numFrames-1]). Entre dos frames
+    // con los mismos cuerpos interpola linealmente; si el conjunto cambió, usa el más cercano.
+    bool muestrear(double posicion, FrameTrayectoria& salida);
+
+    EstadisticasReproduccion estadisticas() const;
+
+private:
+    using Chunk = std::shared_ptr<const std::vector<FrameTrayectoria>>;
+
+    static constexpr size_t CHUNKS_EN_CACHE = 6;
+    static constexpr size_t CHUNKS_ADELANTE = 2;
+
+    LectorTrayectoria lector;
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::vector<std::pair<size_t, Chunk>> cache;  // el más reciente al final
+    std::vector<size_t> pendientes;
+    EstadisticasReproduccion stats;
+    bool salir = false;
+    std::thread hilo;
+
+    size_t ultimoChunk = SIZE_MAX;
+    int sentido = 1;
+
+    Chunk buscarEnCache(size_t c);
+    void guardarEnCache(size_t c, Chunk chunk);
+    Chunk obtener(size_t c);
+    void pedirPrecarga(size_t c);
+    void bucle();
+};
+
+// APARIENCIA DE LOS CUERPOS AL REPRODUCIR
+// La trayectoria solo guarda posiciones; radio y color salen de un snapshot
+// (indexados por IdCuerpo::indice) o de los valores por defecto.
+struct AparienciaCuerpos {
+    std::vector<float> radio;
+    std::vector<Color> color;
+    float radioPorDefecto = 0.03f;
+    Color colorPorDefecto{1.0f, 1.0f, 1.0f};
+
+    template <typename P>
+    void desde(const Particulas<P>& p) {
+        for (size_t i = 0; i < p.size(); ++i) {
+            uint32_t id = p.idDe(i).indice;
+            if (id >= radio.size()) {
+                radio.resize(id + 1, radioPorDefecto);
+                color.resize(id + 1, colorPorDefecto);
+            }
+            radio[id] = float(p.radius[i]);
+            color[id] = p.color[i];
+        }
+    }
+};
+
+// Vuelca un frame reproducido en 'destino' para pintarlo como si fuera el estado simulado.
+template <typename P>
+void volcarFrame(const FrameTrayectoria& frame, const AparienciaCuerpos& apariencia, Particulas<P>& destino) {
+    using T = typename P::Almacen;
+    const size_t n = frame.ids.size();
+    // Los ids solo cambian entre chunks (o al cambiar de cuerpos): el mapa se rehace entonces
+    bool mismosIds = destino.size() == n;
+    for (size_t i = 0; mismosIds && i < n; ++i) mismosIds = destino.idDe(i).indice == frame.ids[i];
+    destino.paraCadaColumna([n](const char*, auto& col) { col.resize(n); });
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t id = frame.ids[i];
+        destino.xPos[i] = destino.xPrev[i] = T(frame.x[i]);
+        destino.yPos[i] = destino.yPrev[i] = T(frame.y[i]);
+        destino.zPos[i] = destino.zPrev[i] = T(frame.z[i]);
+        destino.vx[i] = destino.vy[i] = destino.vz[i] = T(0);
+        destino.masa[i] = T(0);
+        destino.flags[i] = 0;
+        const bool conocido = id < apariencia.radio.size();
+        destino.radius[i] = T(conocido ? apariencia.radio[id] : apariencia.radioPorDefecto);
+        destino.color[i] = conocido ? apariencia.color[id] : apariencia.colorPorDefecto;
+    }
+    if (!mismosIds && !destino.reconstruirIds(frame.ids.data())) destino.reconstruirIds(); // ids corruptos: 0..n-1
+}
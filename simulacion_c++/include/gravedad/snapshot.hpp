@@ -0,0 +1,214 @@
+#pragma once
+
+#include <gravedad/particulas.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// FORMATO DE SNAPSHOT (.grav)
+// Little-endian, SoA. Disposición:
+//   [CabeceraSnapshot: 64 bytes]
+//   [EntradaColumna x numColumnas: directorio]
+//   [columnas, cada una empezando en un offset múltiplo de 64]
+// Las columnas se pueden mapear con mmap directamente en Particulas sin parsear.
+
+// v2: acumulador del paso fijo en la cabecera (en v1 era reservado y vale 0)
+constexpr uint32_t VERSION_SNAPSHOT = 2;
+constexpr size_t ALINEACION_SNAPSHOT = 64;
+
+enum class TipoColumna : uint32_t {
+    F32 = 1,
+    F64 = 2,
+    F80 = 3,     // long double de x86-64 (16 bytes en memoria)
+    U8 = 4,
+    RGB32F = 5,  // Color
+    U32 = 6,
+};
+
+struct CabeceraSnapshot {
+    char magia[8];              // "GRAVSNAP"
+    uint32_t version;
+    uint32_t numColumnas;
+    uint64_t numCuerpos;
+    uint64_t paso;
+    double tiempo;
+    uint64_t offsetDirectorio;
+    double acumulador;          // resto del acumulador de paso fijo (reinicio exacto)
+    uint8_t reservado[8];
+};
+static_assert(sizeof(CabeceraSnapshot) == 64, "la cabecera del snapshot ocupa 64 bytes");
+
+struct EntradaColumna {
+    char nombre[24];
+    uint32_t tipo;              // TipoColumna
+    uint32_t bytesElemento;
+    uint64_t offset;            // desde el inicio del archivo
+    uint64_t bytes;
+};
+static_assert(sizeof(EntradaColumna) == 48, "cada entrada del directorio ocupa 48 bytes");
+
+struct MetadatosSnapshot {
+    uint64_t paso = 0;
+    double tiempo = 0.0;
+    double acumulador = 0.0;
+};
+
+template <typename T> constexpr TipoColumna tipoColumna();
+template <> constexpr TipoColumna tipoColumna<float>() { return TipoColumna::F32; }
+template <> constexpr TipoColumna tipoColumna<double>() { return TipoColumna::F64; }
+template <> constexpr TipoColumna tipoColumna<long double>() { return TipoColumna::F80; }
+template <> constexpr TipoColumna tipoColumna<uint8_t>() { return TipoColumna::U8; }
+template <> constexpr TipoColumna tipoColumna<Color>() { return TipoColumna::RGB32F; }
+template <> constexpr TipoColumna tipoColumna<uint32_t>() { return TipoColumna::U32; }
+
+// Bytes de un elemento de cada tipo (0 si el tipo no se conoce)
+constexpr uint32_t bytesTipoColumna(TipoColumna t) {
+    switch (t) {
+    case TipoColumna::F32: return sizeof(float);
+    case TipoColumna::F64: return sizeof(double);
+    case TipoColumna::F80: return sizeof(long double);
+    case TipoColumna::U8: return sizeof(uint8_t);
+    case TipoColumna::RGB32F: return sizeof(Color);
+    case TipoColumna::U32: return sizeof(uint32_t);
+    }
+    return 0;
+}
+
+// COLUMNA A ESCRIBIR
+struct ColumnaSnapshot {
+    const char* nombre;
+    TipoColumna tipo;
+    uint32_t bytesElemento;
+    const void* datos;
+};
+
+// Escribe el archivo completo. Devuelve false (y avisa por cerr) si falla.
+bool escribirSnapshot(const std::string& ruta, const MetadatosSnapshot& meta, uint64_t numCuerpos,
+                      const std::vector<ColumnaSnapshot>& columnas);
+
+// SNAPSHOT MAPEADO EN MEMORIA
+// Mapea el archivo con MAP_PRIVATE: las columnas se pueden modificar en sitio
+// (copy-on-write) sin tocar el archivo.
+class SnapshotMapeado {
+public:
+    bool abrir(const std::string& ruta);
+
+    uint64_t numCuerpos() const { return cabecera ? cabecera->numCuerpos : 0; }
+    MetadatosSnapshot metadatos() const;
+    const EntradaColumna* buscar(const char* nombre) const;
+    void* datos(const EntradaColumna& e) const { return base + e.offset; }
+
+    // Mantiene viva la región mientras alguna columna la use
+    const std::shared_ptr<void>& region() const { return propietario; }
+
+private:
+    std::shared_ptr<void> propietario;
+    uint8_t* base = nullptr;
+    const CabeceraSnapshot* cabecera = nullptr;
+    const EntradaColumna* directorio = nullptr;
+};
+
+// GUARDAR PARTÍCULAS
+template <typename P>
+bool guardarSnapshot(const Particulas<P>& p, const std::string& ruta, const MetadatosSnapshot& meta = {}) {
+    std::vector<ColumnaSnapshot> columnas;
+    p.paraCadaColumna([&](const char* nombre, const auto& col) {
+        using E = typename std::decay<decltype(col[0])>::type;
+        columnas.push_back({nombre, tipoColumna<E>(), uint32_t(sizeof(E)), col.data()});
+    });
+
+    // Ids estables para poder seguir cada cuerpo entre snapshots
+    std::vector<uint32_t> indices(p.size()), generaciones(p.size());
+    for (size_t i = 0; i < p.size(); ++i) {
+        IdCuerpo id = p.idDe(i);
+        indices[i] = id.indice;
+        generaciones[i] = id.generacion;
+    }
+    columnas.push_back({"id", TipoColumna::U32, 4, indices.data()});
+    columnas.push_back({"generacion", TipoColumna::U32, 4, generaciones.data()});
+
+    return escribirSnapshot(ruta, meta, p.size(), columnas);
+}
+
+// CONVERSIÓN ENTRE ESCALARES (snapshot en otra precisión)
+template <typename T>
+bool convertirColumna(const SnapshotMapeado& s, const EntradaColumna& e, Columna<T>& col, size_t n) {
+    if constexpr (std::is_floating_point<T>::value) {
+        col.resize(n);
+        const void* src = s.datos(e);
+        switch (static_cast<TipoColumna>(e.tipo)) {
+        case TipoColumna::F32: for (size_t i = 0; i < n; ++i) col[i] = T(static_cast<const float*>(src)[i]); return true;
+        case TipoColumna::F64: for (size_t i = 0; i < n; ++i) col[i] = T(static_cast<const double*>(src)[i]); return true;
+        case TipoColumna::F80: for (size_t i = 0; i < n; ++i) col[i] = T(static_cast<const long double*>(src)[i]); return true;
+        default: return false;
+        }
+    }
+    return false;
+}
+
+// CARGAR PARTÍCULAS
+// Si la precisión del archivo coincide con la de P no se copia nada: las
+// columnas apuntan a la memoria mapeada. Si no, se convierten.
+template <typename P>
+bool cargarSnapshot(const std::string& ruta, Particulas<P>& p, MetadatosSnapshot* meta = nullptr) {
+    SnapshotMapeado s;
+    if (!s.abrir(ruta)) return false;
+
+    const size_t n = s.numCuerpos();
+    bool ok = true;
+    p.limpiar();
+    p.paraCadaColumna([&](const char* nombre, auto& col) {
+        using E = typename std::decay<decltype(col[0])>::type;
+        const EntradaColumna* e = s.buscar(nombre);
+        if (!e) {
+            // Columnas opcionales
+            if constexpr (std::is_same<E, Color>::value) col.assign(n, Color{1.0f, 1.0f, 1.0f});
+            else col.assign(n, E());
+            return;
+        }
+        const uint32_t bytesTipo = bytesTipoColumna(static_cast<TipoColumna>(e->tipo));
+        if (bytesTipo == 0 || e->bytesElemento != bytesTipo) {
+            // El tamaño del elemento lo dicta el tipo: si no, convertir leería de más
+            std::cerr << "Snapshot " << ruta << ": tipo incompatible en la columna " << nombre << "\n";
+            ok = false;
+        } else if (e->bytes / e->bytesElemento < n) {
+            std::cerr << "Snapshot " << ruta << ": columna " << nombre << " truncada\n";
+            ok = false;
+        } else if (e->tipo == uint32_t(tipoColumna<E>()) && e->bytesElemento == sizeof(E)) {
+            col.adoptar(static_cast<E*>(s.datos(*e)), n, s.region());
+        } else if (!convertirColumna(s, *e, col, n)) {
+            std::cerr << "Snapshot " << ruta << ": tipo incompatible en la columna " << nombre << "\n";
+            ok = false;
+        }
+    });
+    if (!ok) {
+        p.limpiar();
+        return false;
+    }
+
+    // Sin posición anterior (snapshot de otro integrador) se usa la actual
+    if (!s.buscar("xPrev")) p.xPrev = p.xPos;
+    if (!s.buscar("yPrev")) p.yPrev = p.yPos;
+    if (!s.buscar("zPrev")) p.zPrev = p.zPos;
+
+    // Ids estables: solo si las dos columnas están completas y los ids son válidos
+    auto columnaU32 = [&](const EntradaColumna* e) {
+        return e && e->tipo == uint32_t(TipoColumna::U32) && e->bytesElemento == 4 && e->bytes / 4 >= n;
+    };
+    const EntradaColumna* ids = s.buscar("id");
+    const EntradaColumna* gens = s.buscar("generacion");
+    const bool conIds = columnaU32(ids) && columnaU32(gens);
+    if (!conIds || !p.reconstruirIds(static_cast<const uint32_t*>(s.datos(*ids)),
+                                     static_cast<const uint32_t*>(s.datos(*gens)))) {
+        if (ids || gens) std::cerr << "Aviso: snapshot " << ruta << " con ids no válidos, se numeran de nuevo\n";
+        p.reconstruirIds();
+    }
+
+    if (meta) *meta = s.metadatos();
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cmath>
+
+// KERNELS DE SUAVIZADO GRAVITATORIO
+// Cada política devuelve inversoCubo(r2) = f(r) / r, de modo que la aceleración
+// de un par es G * m * d * inversoCubo(|d|^2), y potencial(r2), el equivalente
+// suavizado de 1/r: la energía del par es -G * m_i * m_j * potencial(|d|^2).
+// No tienen ramas: el compilador puede vectorizar el bucle interno. Se eligen en
+// tiempo de compilación como parámetro de plantilla de los kernels de fuerza.
+
+// CORTE DURO (comportamiento antiguo): los pares más cercanos que sqrt(distSqMin) no interactúan
+template <typename T>
+struct SuavizadoCorte {
+    T distSqMin;
+
+    explicit SuavizadoCorte(T distSqMin_) : distSqMin(distSqMin_) {}
+
+    T inversoCubo(T r2) const {
+        T r2s = r2 > distSqMin ? r2 : T(1);
+        T inv = T(1) / (r2s * std::sqrt(r2s));
+        return r2 > distSqMin ? inv : T(0);
+    }
+
+    // Los pares que no interactúan tampoco suman energía
+    T potencial(T r2) const {
+        T r2s = r2 > distSqMin ? r2 : T(1);
+        T inv = T(1) / std::sqrt(r2s);
+        return r2 > distSqMin ? inv : T(0);
+    }
+};
+
+// PLUMMER: 1 / (r^2 + eps^2)^(3/2)
+template <typename T>
+struct SuavizadoPlummer {
+    T eps2;
+
+    explicit SuavizadoPlummer(T eps) : eps2(eps * eps) {}
+
+    T inversoCubo(T r2) const {
+        T r2s = r2 + eps2;
+        return T(1) / (r2s * std::sqrt(r2s));
+    }
+
+    // 1 / (r^2 + eps^2)^(1/2)
+    T potencial(T r2) const { return T(1) / std::sqrt(r2 + eps2); }
+};
+
+// SPLINE CÚBICO (Monaghan & Lattanzio, como en GADGET)
+// Newtoniano exacto a partir de h = 2.8 eps; eps es la longitud Plummer equivalente.
+template <typename T>
+struct SuavizadoSpline {
+    T h, hInv, hInv3;
+
+    explicit SuavizadoSpline(T eps) : h(T(2.8) * eps), hInv(T(1) / h), hInv3(hInv * hInv * hInv) {}
+
+    T inversoCubo(T r2) const {
+        T r = std::sqrt(r2);
+        T u = r * hInv;
+        T u2 = u * u;
+        T uSeguro = u > T(0.5) ? u : T(0.5); // evita 1/u^3 con u = 0 en la rama que no se usa
+        T r2Seguro = r2 > h * h ? r2 : h * h;
+
+        T interior = hInv3 * (T(10.666666666667) + u2 * (T(32.0) * u - T(38.4)));
+        T medio = hInv3 * (T(21.333333333333) - T(48.0) * u + T(38.4) * u2 - T(10.666666666667) * u2 * u
+                           - T(0.066666666667) / (uSeguro * uSeguro * uSeguro));
+        T exterior = T(1) / (r2Seguro * std::sqrt(r2Seguro));
+
+        T dentro = u < T(0.5) ? interior : medio;
+        return u < T(1) ? dentro : exterior;
+    }
+
+    // Potencial del mismo spline (con el signo cambiado): 1/r a partir de h
+    T potencial(T r2) const {
+        T r = std::sqrt(r2);
+        T u = r * hInv;
+        T u2 = u * u;
+        T uSeguro = u > T(0.5) ? u : T(0.5);
+        T rSeguro = r > h ? r : h;
+
+        T interior = hInv * (T(2.8) - u2 * (T(5.333333333333) + u2 * (T(6.4) * u - T(9.6))));
+        T medio = hInv * (T(3.2) - T(0.066666666667) / uSeguro
+                          - u2 * (T(10.666666666667) + u * (T(-16.0) + u * (T(9.6) - T(2.133333333333) * u))));
+        T exterior = T(1) / rSeguro;
+
+        T dentro = u < T(0.5) ? interior : medio;
+        return u < T(1) ? dentro : exterior;
+    }
+};
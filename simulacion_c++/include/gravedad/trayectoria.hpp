@@ -0,0 +1,200 @@
+#pragma once
+
+#include <gravedad/cola.hpp>
+#include <gravedad/particulas.hpp>
+#include <gravedad/perfilador.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// FORMATO DE TRAYECTORIA (.tray)
+// Posiciones (float32) cada K pasos, agrupadas en chunks de varios frames:
+//   [CabeceraTrayectoria]
+//   [CabeceraChunk + datos] ...
+//   [EntradaIndiceTrayectoria x numChunks][PieTrayectoria]
+// Cada chunk se codifica y comprime por separado, así se puede leer el frame t
+// descomprimiendo solo su chunk. Si falta el índice (escritor interrumpido) el
+// lector recorre los chunks para reconstruirlo.
+
+constexpr uint32_t VERSION_TRAYECTORIA = 1;
+
+enum class CodecTrayectoria : uint32_t {
+    CRUDO = 0,      // float32 tal cual
+    CUANTIZADO = 1, // con pérdida: enteros de paso 2*errorMax, delta temporal, zigzag + varint
+    XOR = 2,        // sin pérdida: bits XOR frame anterior + byte shuffle (pensado para zstd)
+};
+
+struct CabeceraTrayectoria {
+    char magia[8];              // "GRAVTRAY"
+    uint32_t version;
+    uint32_t codec;
+    uint32_t framesPorChunk;
+    uint32_t reservado;
+    double errorMax;
+};
+
+struct CabeceraChunk {
+    char magia[4];              // "CHNK"
+    uint32_t codec;
+    uint32_t zstd;              // 1 si 'datos' está comprimido con zstd
+    uint32_t numFrames;
+    uint64_t numCuerpos;
+    uint64_t primerFrame;
+    uint64_t bytesCodificados;  // antes de zstd
+    uint64_t bytesGuardados;    // en disco
+    double errorMax;
+};
+
+struct EntradaIndiceTrayectoria {
+    uint64_t primerFrame;
+    uint64_t numFrames;
+    uint64_t offset;
+};
+
+struct PieTrayectoria {
+    uint64_t offsetIndice;
+    uint64_t numChunks;
+    uint64_t numFrames;
+    char magia[8];              // "GRAVINDX"
+};
+
+struct OpcionesTrayectoria {
+    CodecTrayectoria codec = CodecTrayectoria::CUANTIZADO;
+    // Solo CUANTIZADO, > 0: error absoluto máximo por coordenada al cuantizar. Lo leído
+    // vuelve como float, así que a eso se suma medio ulp del float de la coordenada
+    // (~3e-8 * |x|): por debajo de esa escala el límite real es el del float.
+    double errorMax = 1e-5;
+    uint32_t framesPorChunk = 32;
+    size_t chunksEnCola = 4;    // tamaño de la cola hacia el hilo de E/S
+    bool zstd = true;           // se ignora si se compiló sin zstd
+};
+
+// UN FRAME DE TRAYECTORIA
+struct FrameTrayectoria {
+    double tiempo = 0.0;
+    std::vector<uint32_t> ids;  // id estable (IdCuerpo::indice) de cada posición
+    std::vector<float> x, y, z;
+};
+
+struct EstadisticasTrayectoria {
+    uint64_t frames = 0;
+    uint64_t chunks = 0;
+    uint64_t bytesCrudos = 0;
+    uint64_t bytesEscritos = 0;
+    uint64_t esperas = 0;       // veces que la cola estaba llena
+    bool error = false;         // falló alguna escritura: el archivo está incompleto
+};
+
+// ESCRITOR DE TRAYECTORIAS
+// anadirFrame() solo copia posiciones en el chunk en curso. Al llenarse, el chunk
+// pasa por una cola acotada a un hilo de E/S que lo codifica, comprime y escribe.
+class EscritorTrayectoria {
+public:
+    EscritorTrayectoria() = default;
+    ~EscritorTrayectoria() { cerrar(); }
+
+    EscritorTrayectoria(const EscritorTrayectoria&) = delete;
+    EscritorTrayectoria& operator=(const EscritorTrayectoria&) = delete;
+
+    bool abrir(const std::string& ruta, const OpcionesTrayectoria& opciones = {});
+    bool abierto() const { return archivo != nullptr; }
+
+    void anadirFrame(const float* x, const float* y, const float* z, const uint32_t* ids, size_t n, double tiempo);
+
+    template <typename P>
+    void anadirFrame(const Particulas<P>& p, double tiempo) {
+        ZONA("trayectoria frame");
+        const size_t n = p.size();
+        xTmp.resize(n);
+        yTmp.resize(n);
+        zTmp.resize(n);
+        idsTmp.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            xTmp[i] = float(p.xPos[i]);
+            yTmp[i] = float(p.yPos[i]);
+            zTmp[i] = float(p.zPos[i]);
+            idsTmp[i] = p.idDe(i).indice;
+        }
+        anadirFrame(xTmp.data(), yTmp.data(), zTmp.data(), idsTmp.data(), n, tiempo);
+    }
+
+    // Vacía el chunk en curso, espera al hilo y escribe el índice.
+    void cerrar();
+
+    // Se puede llamar durante la grabación (los dos hilos actualizan con el mutex)
+    EstadisticasTrayectoria estadisticas() const {
+        std::lock_guard<std::mutex> lock(mStats);
+        return stats;
+    }
+
+private:
+    struct Chunk {
+        uint64_t primerFrame = 0;
+        uint32_t numFrames = 0;
+        std::vector<double> tiempos;
+        std::vector<uint32_t> ids;
+        std::vector<float> xyz;  // por frame: x[n], y[n], z[n]
+    };
+
+    std::FILE* archivo = nullptr;
+    std::string ruta;
+    OpcionesTrayectoria opciones;
+    Chunk actual;
+    uint64_t framesTotales = 0;
+    std::vector<EntradaIndiceTrayectoria> indice;
+    std::unique_ptr<ColaAcotada<Chunk>> cola;
+    std::thread hilo;
+    mutable std::mutex mStats;
+    EstadisticasTrayectoria stats;
+    bool error = false;         // solo el hilo de E/S hasta el join de cerrar()
+    std::vector<float> xTmp, yTmp, zTmp;
+    std::vector<uint32_t> idsTmp;
+
+    void enviarChunk();
+    void bucleEscritura();
+    void escribirChunk(const Chunk& c);
+};
+
+// LECTOR DE TRAYECTORIAS CON ACCESO ALEATORIO
+// El archivo se mapea con mmap; leer un chunk es solo apuntar a su posición.
+class LectorTrayectoria {
+public:
+    ~LectorTrayectoria() { cerrar(); }
+
+    bool abrir(const std::string& ruta);
+    void cerrar();
+
+    uint64_t numFrames() const { return framesTotales; }
+    size_t numChunks() const { return indice.size(); }
+    const EntradaIndiceTrayectoria& entrada(size_t c) const { return indice[c]; }
+    size_t buscarChunk(uint64_t t) const;
+
+    // Descomprime solo el chunk que contiene t (el último chunk leído queda en caché).
+    bool leerFrame(uint64_t t, FrameTrayectoria& frame);
+
+    // Decodifica el chunk c completo. No toca la caché: se puede llamar desde otro hilo.
+    bool leerChunk(size_t c, std::vector<FrameTrayectoria>& frames) const;
+
+    // Pide al sistema que vaya leyendo el chunk c del disco (read-ahead).
+    void precargar(size_t c) const;
+
+    // Decodifica un chunk completo desde su representación en disco.
+    static bool decodificarChunk(const CabeceraChunk& cab, const uint8_t* datos, std::vector<FrameTrayectoria>& frames);
+
+private:
+    uint8_t* base = nullptr;
+    size_t bytes = 0;
+    uint64_t framesTotales = 0;
+    std::vector<EntradaIndiceTrayectoria> indice;
+
+    size_t chunkEnCache = SIZE_MAX;
+    std::vector<FrameTrayectoria> cache;
+
+    bool reconstruirIndice();
+    const CabeceraChunk* cabeceraChunk(size_t c) const;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <render/esferas.hpp>
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ANILLO DE INSTANCIAS EN MEMORIA VISIBLE POR LA GPU
+// Con GL 4.4 o ARB_buffer_storage el buffer se mapea una vez de forma persistente y
+// coherente, partido en NUM_TRAMOS_ANILLO tramos: cada frame escribe en el siguiente
+// tramo, y antes de reutilizarlo se espera a la fence del frame que lo usó. Así el
+// recorte escribe las instancias directamente donde las lee la GPU, sin copias del
+// driver ni esperas implícitas.
+// Sin glBufferStorage (GL 3.3) cada frame deja huérfano el buffer con glBufferData y
+// lo mapea con GL_MAP_INVALIDATE_BUFFER_BIT: tampoco hay copia intermedia, pero el
+// driver puede tener que reservar memoria nueva cada vez.
+//
+// Uso por frame: escribir(n) -> rellenar -> publicar() -> dibujar -> terminarFrame().
+constexpr int NUM_TRAMOS_ANILLO = 3;
+
+class AnilloInstancias {
+public:
+    // 'cargar' busca glBufferStorage, que no está en glad (que llega a GL 4.3).
+    // Con cargar = nullptr se usa siempre el camino de GL 3.3.
+    bool crear(GLADloadproc cargar, size_t instanciasPorFrame = size_t(1) << 16);
+    void destruir();
+
+    // Memoria para n instancias del frame actual; crece si no caben
+    InstanciaEsfera* escribir(size_t n);
+    // Deja las instancias listas para dibujar. false si el driver perdió los datos.
+    bool publicar();
+    // Fence del tramo usado en este frame; pasa al siguiente
+    void terminarFrame();
+
+    GLuint buffer() const { return vbo; }
+    size_t primera() const { return primeraInstancia; } // índice de la primera instancia del frame
+    bool persistente() const { return mapa != nullptr; }
+    uint64_t esperas() const { return numEsperas; }      // frames en los que la GPU iba atrasada
+
+private:
+    bool crearAlmacen(size_t instanciasPorFrame);
+    void esperarTramo(int t);
+
+    using FuncionBufferStorage = void(APIENTRYP)(GLenum, GLsizeiptr, const void*, GLbitfield);
+    FuncionBufferStorage bufferStorage = nullptr;
+
+    GLuint vbo = 0;
+    InstanciaEsfera* mapa = nullptr; // mapeo persistente (nullptr en el camino de GL 3.3)
+    size_t capacidadTramo = 0;       // instancias por tramo
+    GLsync fences[NUM_TRAMOS_ANILLO] = {};
+    int tramo = 0;
+    size_t primeraInstancia = 0;
+    bool mapeado = false;            // camino de GL 3.3: buffer mapeado hasta publicar()
+    uint64_t numEsperas = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// DATOS DE CÁMARA Y LUZ DE UN FRAME
+// Es el bloque uniform 'Camara' de los shaders con layout std140: se sube una vez
+// por frame y lo comparten todos los programas. Solo mat4 y vec4, así el
+// layout de C++ coincide con std140 sin relleno.
+struct DatosCamara {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPos;
+    glm::vec4 lightColor;
+    glm::vec4 viewPos;
+};
+static_assert(sizeof(DatosCamara) == 176, "DatosCamara debe coincidir con el bloque std140");
+
+// Declaración GLSL del bloque (para pegar en los shaders)
+#define GLSL_BLOQUE_CAMARA              \
+    "layout(std140) uniform Camara {\n" \
+    "    mat4 view;\n"                  \
+    "    mat4 projection;\n"            \
+    "    vec4 lightPos;\n"              \
+    "    vec4 lightColor;\n"            \
+    "    vec4 viewPos;\n"               \
+    "};\n"
+
+constexpr GLuint ENLACE_CAMARA = 0; // punto de enlace del bloque
+
+// Conecta el bloque 'Camara' de un programa recién enlazado al punto de enlace
+bool enlazarBloqueCamara(GLuint programa);
+
+// BUFFER UNIFORM DE LA CÁMARA
+class BufferCamara {
+public:
+    bool crear();
+    void actualizar(const DatosCamara& datos);
+    void destruir();
+
+private:
+    GLuint ubo = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <render/camara.hpp>
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// DATOS DE UN CUERPO PARA EL RENDER (atributos por instancia)
+struct InstanciaEsfera {
+    float x, y, z, radio;
+    float r, g, b, a;
+};
+static_assert(sizeof(InstanciaEsfera) == 32, "instancia de 32 bytes");
+
+// Apunta los atributos por instancia (2: centro y radio, 3: color) del VAO enlazado a
+// partir de la instancia 'primera' del GL_ARRAY_BUFFER enlazado. Sustituye a
+// glDrawElementsInstancedBaseInstance, que es de GL 4.2.
+void apuntarInstancias(size_t primera);
+
+// MALLA DE UNA ESFERA UNIDAD: posición y normal intercaladas, 2 triángulos por sector
+void crearEsfera(std::vector<float>& vertices, std::vector<unsigned int>& indices, int sectorCount, int stackCount);
+
+// NIVELES DE DETALLE
+// Cada nivel tiene la mitad de sectores y pilas que el anterior. Un cuerpo usa el nivel
+// más basto cuyas aristas en pantalla no pasan de PIXELES_ARISTA_LOD, así que los
+// lejanos cuestan unas decenas de triángulos en lugar de ~1300.
+constexpr int NIVELES_LOD = 4;
+constexpr float PIXELES_ARISTA_LOD = 4.0f;
+
+// RENDER DE ESFERAS INSTANCIADO
+// Una llamada de dibujo por nivel de detalle: la posición, el radio y el color van
+// como atributos por instancia y la cámara en el bloque uniform 'Camara' (ver
+// camara.hpp), así el coste en CPU y en el driver no crece con N. Las instancias
+// llegan ya agrupadas por nivel (ver RecorteCuerpos).
+class RenderEsferas {
+public:
+    // sectores y pilas del nivel 0 (el más fino)
+    bool iniciar(int sectores = 36, int pilas = 18);
+    // Radio máximo en pantalla de cada nivel (para Frustum::radioMaxNivel)
+    void limitesLod(float radioMaxNivel[NIVELES_LOD]) const;
+    // Dibuja cuentaNivel[k] instancias de cada nivel, seguidas a partir de 'primera' en 'buffer'
+    void dibujar(GLuint buffer, size_t primera, const size_t cuentaNivel[NIVELES_LOD]);
+    void destruir();
+
+private:
+    struct Malla {
+        int sectores = 0;
+        GLsizei numIndices = 0;
+        size_t primerIndice = 0;
+        GLint primerVertice = 0;
+    };
+
+    GLuint programa = 0;
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    Malla mallas[NIVELES_LOD];
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <gravedad/particulas.hpp>
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+// ESTELAS DE LAS ÓRBITAS
+// Las últimas 'longitud' posiciones de cada cuerpo viven en la GPU, en un anillo de
+// ranuras: la ranura r guarda la posición de todos los cuerpos en un frame, así que
+// cada frame se sube una sola ranura (N posiciones, no N x longitud). El vertex
+// shader lee la estela de cada cuerpo del buffer de textura, de la más nueva a la
+// más vieja, y la dibuja como una línea que se desvanece con la edad.
+// La memoria es fija: N x longitud x 16 bytes. Si cambia el número de cuerpos
+// (escapados, fusiones) los índices ya no corresponden y las estelas empiezan de nuevo.
+class RenderEstelas {
+public:
+    bool iniciar(size_t longitud);
+    // Añade la posición actual de cada cuerpo como muestra más nueva
+    // (C: Particulas<P> o CuerposInterpolados<P>)
+    template <typename C>
+    void anadir(const C& p);
+    // Después de las esferas: mezcla alfa y sin escribir profundidad
+    void dibujar();
+    void destruir();
+
+    size_t bytes() const { return cuerpos * longitud * 4 * sizeof(float); }
+
+private:
+    void subirMuestra(size_t n);
+
+    GLuint programa = 0;
+    GLuint vao = 0;
+    GLuint vboColores = 0;
+    GLuint bufferMuestras = 0, texturaMuestras = 0;
+    GLint locCuerpos = -1, locLongitud = -1, locCabeza = -1, locNumMuestras = -1;
+
+    size_t longitudPedida = 0; // la de iniciar()
+    size_t longitud = 0;     // muestras por cuerpo: la pedida, o menos si N x longitud no cabe (0: sin estelas)
+    size_t cuerpos = 0;      // cuerpos para los que está reservado el anillo
+    size_t cabeza = 0;       // ranura de la muestra más nueva
+    size_t numMuestras = 0;  // ranuras ya escritas (hasta 'longitud')
+    std::vector<float> muestra; // x, y, z, 1 de cada cuerpo
+    std::vector<float> colores; // r, g, b de cada cuerpo (solo al empezar de nuevo)
+};
+
+template <typename C>
+void RenderEstelas::anadir(const C& p) {
+    const size_t n = p.size();
+    muestra.resize(4 * n);
+    for (size_t i = 0; i < n; ++i) {
+        muestra[4 * i + 0] = float(p.xPos[i]);
+        muestra[4 * i + 1] = float(p.yPos[i]);
+        muestra[4 * i + 2] = float(p.zPos[i]);
+        muestra[4 * i + 3] = 1.0f;
+    }
+    if (n != cuerpos) {
+        colores.resize(3 * n);
+        for (size_t i = 0; i < n; ++i) {
+            colores[3 * i + 0] = p.color[i].r;
+            colores[3 * i + 1] = p.color[i].g;
+            colores[3 * i + 2] = p.color[i].b;
+        }
+    }
+    subirMuestra(n);
+}
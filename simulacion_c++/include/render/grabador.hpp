@@ -0,0 +1,81 @@
+#pragma once
+
+#include <gravedad/cola.hpp>
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class FormatoCaptura : uint8_t {
+    PNG, // una imagen por frame
+    YUV, // vídeo crudo yuv420p (BT.601, rango limitado) seguido
+};
+
+// GRABADOR DE FRAMES
+// capturar() encola un glReadPixels hacia un pixel buffer object y vuelve sin esperar:
+// la copia se hace mientras se dibuja el frame siguiente. Cada PBO se lee
+// NUM_PBO_CAPTURA - 1 frames después, con su fence ya pasada, y la imagen va por una
+// cola acotada a un hilo que la codifica y la escribe, así el bucle de render no se
+// para ni en la lectura ni en la compresión.
+constexpr int NUM_PBO_CAPTURA = 3;
+
+class GrabadorFrames {
+public:
+    GrabadorFrames() = default;
+    ~GrabadorFrames() { cerrar(); }
+
+    GrabadorFrames(const GrabadorFrames&) = delete;
+    GrabadorFrames& operator=(const GrabadorFrames&) = delete;
+
+    // PNG: 'destino' es un patrón printf con un solo %d para el número de frame
+    // ("frames/f%05d.png"; leerOpciones lo comprueba).
+    // YUV: un archivo o, si empieza por '|', un comando que recibe el vídeo por la
+    // entrada estándar ("|ffmpeg -f rawvideo -pix_fmt yuv420p -s 1920x1080 -r 60 -i - v.mp4").
+    bool abrir(const std::string& destino, FormatoCaptura formato, int ancho, int alto);
+    bool abierto() const { return cola != nullptr; }
+
+    // Lee el framebuffer de lectura enlazado (antes de glfwSwapBuffers). Si su tamaño
+    // ya no es el de abrir(), avisa y cierra: las imágenes saldrían recortadas.
+    void capturar(int anchoFb, int altoFb);
+    // Entrega los frames pendientes, espera al hilo y cierra. Con el contexto GL vivo.
+    void cerrar();
+
+    uint64_t escritos() const { return numEscritos.load(); }
+    uint64_t esperas() const { return numEsperas; } // frames en los que el hilo de escritura iba atrasado
+
+private:
+    struct Imagen {
+        uint64_t numero = 0;
+        std::vector<uint8_t> rgba; // de abajo arriba, como lo deja glReadPixels
+    };
+
+    void entregar(int pbo);
+    void bucleEscritura();
+    bool escribirImagen(const Imagen& im);
+
+    std::string destino;
+    FormatoCaptura formato = FormatoCaptura::PNG;
+    int ancho = 0, alto = 0;
+    std::FILE* video = nullptr;
+    bool esTuberia = false;
+
+    GLuint pbos[NUM_PBO_CAPTURA] = {};
+    GLsync fences[NUM_PBO_CAPTURA] = {};
+    uint64_t numeroPbo[NUM_PBO_CAPTURA] = {};
+    int siguiente = 0;
+    uint64_t numFrames = 0;
+
+    std::unique_ptr<ColaAcotada<Imagen>> cola;
+    std::unique_ptr<ColaAcotada<std::vector<uint8_t>>> libres; // buffers ya escritos, para reutilizar
+    std::thread hilo;
+    std::vector<uint8_t> codificado; // solo el hilo de escritura
+    std::atomic<uint64_t> numEscritos{0};
+    uint64_t numEsperas = 0;
+    bool error = false;              // solo el hilo de escritura
+};
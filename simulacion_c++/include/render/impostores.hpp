@@ -0,0 +1,21 @@
+#pragma once
+
+#include <render/esferas.hpp>
+
+// RENDER DE ESFERAS COMO IMPOSTORES
+// Un quad de 4 vértices por cuerpo orientado a la cámara; el fragment shader lanza
+// el rayo contra la esfera exacta, descarta lo que queda fuera y escribe la
+// profundidad y la normal reales, así que las esferas se cortan bien entre sí y la
+// luz es la misma que con la malla. Usa las mismas instancias que RenderEsferas
+// (todas como nivel 0).
+class RenderImpostores {
+public:
+    bool iniciar();
+    // Dibuja n instancias a partir de 'primera' en 'buffer'
+    void dibujar(GLuint buffer, size_t primera, size_t n);
+    void destruir();
+
+private:
+    GLuint programa = 0;
+    GLuint vao = 0;
+};
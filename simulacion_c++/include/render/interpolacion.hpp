@@ -0,0 +1,53 @@
+#pragma once
+
+#include <gravedad/paralelo.hpp>
+#include <gravedad/particulas.hpp>
+#include <gravedad/perfilador.hpp>
+
+#include <algorithm>
+
+// CUERPOS PARA DIBUJAR ENTRE DOS PASOS FIJOS
+// Con paso fijo el estado simulado avanza a saltos de dt y el reloj de pantalla queda
+// entre dos pasos, con un resto 'acumulador' < dt. Se dibuja el estado anterior
+// mezclado con el actual, prev + alfa (actual - prev) con alfa = acumulador / dt: un
+// paso por detrás, pero sin tirones aunque dt sea mayor que lo que dura un frame.
+// Verlet ya guarda el estado anterior en xPrev, así que no hay que copiar nada entre
+// subpasos. Radio y color se leen de las partículas (referencias a sus columnas).
+// Tiene los mismos nombres que Particulas para lo que usan RecorteCuerpos y RenderEstelas.
+template <typename P>
+class CuerposInterpolados {
+public:
+    using T = typename P::Almacen;
+
+    explicit CuerposInterpolados(const Particulas<P>& p) : radius(p.radius), color(p.color) {}
+
+    CuerposInterpolados(const CuerposInterpolados&) = delete;
+    CuerposInterpolados& operator=(const CuerposInterpolados&) = delete;
+
+    // alfa en [0, 1]; con xPrev == xPos (reproducción) da las posiciones tal cual
+    void interpolar(const Particulas<P>& p, T alfa, unsigned hilos);
+
+    size_t size() const { return xPos.size(); }
+
+    Columna<T> xPos, yPos, zPos;
+    const Columna<T>& radius;
+    const Columna<Color>& color;
+};
+
+template <typename P>
+void CuerposInterpolados<P>::interpolar(const Particulas<P>& p, T alfa, unsigned hilos) {
+    ZONA("interpolar");
+    const size_t n = p.size();
+    xPos.resize(n);
+    yPos.resize(n);
+    zPos.resize(n);
+    const size_t MIN_CUERPOS_POR_HILO = 65536; // es solo un recorrido de memoria
+    hilos = unsigned(std::max<size_t>(1, std::min<size_t>(hilos, n / MIN_CUERPOS_POR_HILO)));
+    paraleloEnBloques(n, hilos, [&](size_t inicio, size_t fin, unsigned) {
+        for (size_t i = inicio; i < fin; ++i) {
+            xPos[i] = p.xPrev[i] + alfa * (p.xPos[i] - p.xPrev[i]);
+            yPos[i] = p.yPrev[i] + alfa * (p.yPos[i] - p.yPrev[i]);
+            zPos[i] = p.zPrev[i] + alfa * (p.zPos[i] - p.zPrev[i]);
+        }
+    });
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// COMPILAR Y ENLAZAR UN PROGRAMA DE SHADERS
+// Devuelve 0 si algo falla (el log del driver va a cerr).
+GLuint crearPrograma(const char* fuenteVertices, const char* fuenteFragmentos);
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <gravedad/paralelo.hpp>
+#include <gravedad/particulas.hpp>
+#include <gravedad/perfilador.hpp>
+#include <render/camara.hpp>
+#include <render/esferas.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// PIRÁMIDE DE VISIÓN Y TAMAÑO MÍNIMO EN PANTALLA
+// Los 6 planos salen de projection * view (Gribb-Hartmann), normalizados y separados
+// por componente para que el bucle de recorte se vectorice sobre las columnas SoA.
+// Un punto está dentro del plano k si a[k] x + b[k] y + c[k] z + d[k] >= 0.
+struct Frustum {
+    float a[6], b[6], c[6], d[6];
+    float zx, zy, zz, zw; // profundidad en espacio de cámara: zx x + zy y + zz z + zw
+    float focal;          // radio en píxeles de una esfera de radio 1 a profundidad 1
+    float radioMinPx;     // por debajo de este radio en pantalla el cuerpo no se dibuja
+    // Nivel de detalle: el nivel k (k >= 1) sirve si el radio en pantalla es <= radioMaxNivel[k].
+    // Todo a 0 = todos al nivel 0 (ver RenderEsferas::limitesLod).
+    float radioMaxNivel[NIVELES_LOD];
+};
+
+// altoPixeles: alto del viewport. radioMinPx = 0 desactiva el recorte por tamaño.
+Frustum extraerFrustum(const DatosCamara& camara, float altoPixeles, float radioMinPx);
+
+// RECORTE DE CUERPOS ANTES DE SUBIRLOS A LA GPU
+// Descarta los cuerpos cuya esfera queda fuera de la pirámide de visión o mide menos
+// de radioMinPx en pantalla, y escribe los demás como instancias agrupadas por nivel
+// de detalle (y en el orden original dentro de cada nivel).
+// clasificar() hace una máscara con el nivel de cada cuerpo (0 = invisible) en un
+// bucle vectorizado; escribir() compacta cada bloque de hilos en su tramo de la
+// salida, que puede ser directamente la memoria mapeada del buffer de instancias.
+// No hay árbol espacial en el motor, así que se prueban todos los cuerpos: O(N) pero
+// barato por cuerpo.
+// C es Particulas<P> o CuerposInterpolados<P> (xPos, yPos, zPos, radius, color y size()).
+class RecorteCuerpos {
+public:
+    // Devuelve cuántos cuerpos son visibles
+    template <typename C>
+    size_t clasificar(const C& p, const Frustum& f, unsigned hilos);
+    // Escribe los visibles del último clasificar() en destino[0, visibles())
+    template <typename C>
+    void escribir(const C& p, InstanciaEsfera* destino) const;
+
+    size_t total() const { return numTotal; }
+    size_t visibles() const { return numVisibles; }
+    const size_t* cuentasNivel() const { return cuentaNivel; }
+
+private:
+    std::vector<uint8_t> nivel; // 1 + nivel de detalle, 0 = invisible
+    std::vector<std::array<size_t, NIVELES_LOD>> cuentaBloque;
+    size_t cuentaNivel[NIVELES_LOD] = {};
+    unsigned hilos = 1;
+    size_t numTotal = 0;
+    size_t numVisibles = 0;
+};
+
+namespace detalle_recorte {
+
+template <typename T>
+void clasificarBloque(const T* __restrict x, const T* __restrict y, const T* __restrict z,
+                      const T* __restrict radio, size_t n, const Frustum& f, uint8_t* __restrict nivel,
+                      size_t* __restrict cuenta) {
+    // Copias locales: así el compilador sabe que no cambian dentro del bucle
+    float a[6], b[6], c[6], d[6], radioMax[NIVELES_LOD];
+    std::copy(f.a, f.a + 6, a);
+    std::copy(f.b, f.b + 6, b);
+    std::copy(f.c, f.c + 6, c);
+    std::copy(f.d, f.d + 6, d);
+    std::copy(f.radioMaxNivel, f.radioMaxNivel + NIVELES_LOD, radioMax);
+    const float zx = f.zx, zy = f.zy, zz = f.zz, zw = f.zw;
+    const float focal = f.focal, radioMin = f.radioMinPx;
+
+    // Sin ramas (enteros en lugar de bool y ?:), para que GCC vectorice el bucle
+    for (size_t i = 0; i < n; ++i) {
+        const float xi = float(x[i]), yi = float(y[i]), zi = float(z[i]), r = float(radio[i]);
+        int dentro = 1;
+        for (int k = 0; k < 6; ++k) dentro &= a[k] * xi + b[k] * yi + c[k] * zi + d[k] >= -r;
+        // Radio en pantalla r * focal / profundidad comparado sin dividir
+        const float profundidad = zx * xi + zy * yi + zz * zi + zw;
+        const float rf = r * focal;
+        dentro &= rf >= radioMin * profundidad;
+        int k = 1;
+        for (int j = 1; j < NIVELES_LOD; ++j) k += rf <= radioMax[j] * profundidad;
+        nivel[i] = uint8_t(dentro * k);
+    }
+
+    // Un recorrido por nivel: se vectoriza, un histograma con índice variable no
+    for (int k = 0; k < NIVELES_LOD; ++k) {
+        size_t cuentaK = 0;
+        for (size_t i = 0; i < n; ++i) cuentaK += nivel[i] == k + 1;
+        cuenta[k] = cuentaK;
+    }
+}
+
+} // namespace detalle_recorte
+
+template <typename C>
+size_t RecorteCuerpos::clasificar(const C& p, const Frustum& f, unsigned hilos_) {
+    const size_t n = p.size();
+    const size_t MIN_CUERPOS_POR_HILO = 16384; // por debajo no compensa crear hilos
+    hilos = unsigned(std::max<size_t>(1, std::min<size_t>(hilos_, n / MIN_CUERPOS_POR_HILO)));
+
+    nivel.resize(n);
+    cuentaBloque.assign(hilos, {});
+    paraleloEnBloques(n, hilos, [&](size_t inicio, size_t fin, unsigned bloque) {
+        ZONA("recorte bloque");
+        detalle_recorte::clasificarBloque(p.xPos.data() + inicio, p.yPos.data() + inicio, p.zPos.data() + inicio,
+                                          p.radius.data() + inicio, fin - inicio, f, nivel.data() + inicio,
+                                          cuentaBloque[bloque].data());
+    });
+
+    // Cuentas por bloque -> primera posición de salida de cada (nivel, bloque)
+    numTotal = n;
+    numVisibles = 0;
+    for (int k = 0; k < NIVELES_LOD; ++k) {
+        cuentaNivel[k] = 0;
+        for (auto& c : cuentaBloque) {
+            const size_t cuenta = c[k];
+            c[k] = numVisibles;
+            numVisibles += cuenta;
+            cuentaNivel[k] += cuenta;
+        }
+    }
+    return numVisibles;
+}
+
+template <typename C>
+void RecorteCuerpos::escribir(const C& p, InstanciaEsfera* destino) const {
+    // paraleloEnBloques reparte igual con el mismo n y hilos que en clasificar()
+    paraleloEnBloques(p.size(), hilos, [&](size_t inicio, size_t fin, unsigned bloque) {
+        std::array<size_t, NIVELES_LOD> siguiente = cuentaBloque[bloque];
+        for (size_t i = inicio; i < fin; ++i) {
+            if (!nivel[i]) continue;
+            destino[siguiente[nivel[i] - 1]++] = InstanciaEsfera{
+                float(p.xPos[i]), float(p.yPos[i]), float(p.zPos[i]), float(p.radius[i]),
+                p.color[i].r, p.color[i].g, p.color[i].b, 1.0f};
+        }
+    });
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// CONTEXTO OPENGL SIN VENTANA (nodos de render sin pantalla)
+// EGL con la plataforma 'surfaceless' de Mesa (llvmpipe o GPU), sin X ni Wayland,
+// y un framebuffer propio (color RGBA8 + profundidad de 24 bits) que queda enlazado
+// para dibujar y leer. Necesita compilar con EGL (GRAVEDAD_CON_EGL).
+class ContextoSinVentana {
+public:
+    ContextoSinVentana() = default;
+    ~ContextoSinVentana() { destruir(); }
+
+    ContextoSinVentana(const ContextoSinVentana&) = delete;
+    ContextoSinVentana& operator=(const ContextoSinVentana&) = delete;
+
+    // Crea el contexto (GL 3.3 core), lo hace actual y carga glad
+    bool crear(int ancho, int alto);
+    void destruir();
+
+    // Para los punteros que glad no trae (ver AnilloInstancias)
+    static void* cargar(const char* nombre);
+
+private:
+    void* display = nullptr; // EGLDisplay
+    void* contexto = nullptr; // EGLContext
+    GLuint fbo = 0, color = 0, profundidad = 0;
+};
@@ -3,13 +3,47 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <memory>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+#include <gravedad/integradores.hpp>
+#include <gravedad/checkpoint.hpp>
+#include <gravedad/contadores.hpp>
+#include <gravedad/diagnosticos.hpp>
+#include <gravedad/escenario.hpp>
+#include <gravedad/generadores.hpp>
+#include <gravedad/opciones.hpp>
+#include <gravedad/perfilador.hpp>
+#include <gravedad/reproductor.hpp>
+#include <render/anillo.hpp>
+#include <render/camara.hpp>
+#include <render/esferas.hpp>
+#include <render/estelas.hpp>
+#include <render/grabador.hpp>
+#include <render/impostores.hpp>
+#include <render/recorte.hpp>
+#include <render/sin_ventana.hpp>
 
 // CONFIGURACIÓN
 const float G = 0.0001f; // constante gravitatoria pequeña
 const float restitution = 1.0f;
+const float radioEscape = 50.0f; // distancia a partir de la cual un cuerpo se elimina
+const float epsSuavizado = 0.03f; // longitud de suavizado gravitatorio
+
+// PRECISIÓN DEL MOTOR (se puede cambiar con -DGRAVEDAD_PRECISION=... en CMake)
+#ifndef GRAVEDAD_PRECISION
+#define GRAVEDAD_PRECISION PrecisionSimple
+#endif
+using PrecisionMotor = GRAVEDAD_PRECISION;
+using Escalar = PrecisionMotor::Almacen;
+
+// ESCENAS (CMake define la ruta absoluta; sin CMake se buscan en ./escenarios)
+#ifndef GRAVEDAD_DIR_ESCENARIOS
+#define GRAVEDAD_DIR_ESCENARIOS "escenarios"
+#endif
+
+// SUAVIZADO: SuavizadoPlummer, SuavizadoSpline o SuavizadoCorte (ver gravedad/suavizado.hpp)
+using Suavizado = SuavizadoPlummer<PrecisionMotor::Calculo>;
 
 // CÁMARA
 glm::vec3 cameraPos = glm::vec3(0.0f,0.0f,3.0f);
@@ -20,26 +54,6 @@ float yaw = -90.0f, pitch = 0.0f;
 bool firstMouse = true;
 float sensitivity = 0.001f;
 
-// CLASE OBJETO
-class Objeto {
-public:
-    float xPos, yPos, zPos;
-    float vx, vy, vz;
-    float radius;
-    float masa;
-    glm::vec3 color;
-
-    Objeto(float x, float y, float z, float vx_, float vy_, float vz_, float r, float m, glm::vec3 c)
-        : xPos(x), yPos(y), zPos(z), vx(vx_), vy(vy_), vz(vz_), radius(r), masa(m), color(c) {}
-
-    void update(float dt) {
-        xPos += vx * dt;
-        yPos += vy * dt;
-        zPos += vz * dt;
-
-    }
-};
-
 // CALLBACK PARA AJUSTAR VIEWPORT
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
@@ -61,6 +75,42 @@ void processInput(GLFWwindow *window, float deltaTime) {
         glfwSetWindowShouldClose(window, true);
 }
 
+// CONTROLES DE REPRODUCCIÓN (--reproducir)
+// ESPACIO pausa, FLECHAS IZQ/DER avanzan o retroceden rápido, ARRIBA/ABAJO cambian
+// la velocidad, INICIO/FIN saltan al principio o al final
+struct ControlReproduccion {
+    double posicion = 0.0;   // en frames de la trayectoria (fraccionaria: se interpola)
+    double velocidad = 1.0;
+    bool pausa = false;
+    bool espacioAntes = false, arribaAntes = false, abajoAntes = false;
+};
+
+void procesarReproduccion(GLFWwindow* window, float deltaTime, ControlReproduccion& c, uint64_t numFrames, double framesPorSegundo) {
+    // Sin ventana (--sin-ventana) no hay teclas: la reproducción avanza sola
+    auto pulsada = [window](int tecla) { return window && glfwGetKey(window, tecla) == GLFW_PRESS; };
+    bool espacio = pulsada(GLFW_KEY_SPACE);
+    bool arriba = pulsada(GLFW_KEY_UP);
+    bool abajo = pulsada(GLFW_KEY_DOWN);
+    if (espacio && !c.espacioAntes) c.pausa = !c.pausa;
+    if (arriba && !c.arribaAntes) c.velocidad *= 2.0;
+    if (abajo && !c.abajoAntes) c.velocidad *= 0.5;
+    c.espacioAntes = espacio;
+    c.arribaAntes = arriba;
+    c.abajoAntes = abajo;
+
+    if (!c.pausa) c.posicion += c.velocidad * framesPorSegundo * deltaTime;
+
+    // Arrastrar: diez veces la velocidad normal, también en pausa
+    double arrastre = 10.0 * c.velocidad * framesPorSegundo * deltaTime;
+    if (pulsada(GLFW_KEY_RIGHT)) c.posicion += arrastre;
+    if (pulsada(GLFW_KEY_LEFT)) c.posicion -= arrastre;
+    if (pulsada(GLFW_KEY_HOME)) c.posicion = 0.0;
+    if (pulsada(GLFW_KEY_END)) c.posicion = double(numFrames - 1);
+
+    if (c.posicion < 0.0) c.posicion = 0.0;
+    if (c.posicion > double(numFrames - 1)) c.posicion = double(numFrames - 1);
+}
+
 // USAR EL MOUSE PARA MOVER LA CAMARA
 void mouse_callback(GLFWwindow* window, double xpos, double ypos){
     if (firstMouse){
@@ -90,296 +140,278 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos){
     cameraFront = glm::normalize(front);
 }
 
-// COLISIÓN DE LAS ESFERAS
-void Collision(Objeto &a, Objeto &b){
-    float dx = b.xPos - a.xPos;
-    float dy = b.yPos - a.yPos;
-    float dz = b.zPos - a.zPos;
-    float dist = sqrt(dx*dx + dy*dy + dz*dz);
-    float minDist = a.radius + b.radius;
-
-    if (dist < minDist && dist >0.0f){
-        float nx = dx / dist;
-        float ny = dy / dist;
-        float nz = dz / dist;
-
-        float p = 2 * (a.vx*nx + a.vy*ny + a.vz*nz - b.vx*nx - b.vy*ny - b.vz*nz) / 2.0f;
-
-        a.vx -= p * nx;
-        a.vy -= p * ny;
-        a.vz -= p * nz;
-        b.vx += p * nx;
-        b.vy += p * ny;
-        b.vz += p * nz;
-
-        float overlap = 0.5f * (minDist - dist);
-        a.xPos -= overlap * nx;
-        a.yPos -= overlap * ny;
-        a.zPos -= overlap * nz;
-        b.xPos += overlap * nx;
-        b.yPos += overlap * ny;
-        b.zPos += overlap * nz;
-    }
-}
+int main(int argc, char** argv) {
 
-// ATRACCIÓN ENTRE LAS ESFERAS
-void gravedadMutua(std::vector<Objeto> &objetos, float G, float dt){
-    for (size_t i = 0; i < objetos.size(); i++){
-        for (size_t j = i+1; j < objetos.size(); j++){
-            float dx = objetos[j].xPos - objetos[i].xPos;
-            float dy = objetos[j].yPos - objetos[i].yPos;
-            float dz = objetos[j].zPos - objetos[i].zPos;
-            float distSq = dx*dx + dy*dy + dz*dz;
-
-            if (distSq > 0.001f){
-                float dist = sqrt(distSq);
-                float F = G * objetos[i].masa * objetos[j].masa / distSq;
-
-                float Fx = F * dx / dist;
-                float Fy = F * dy / dist;
-                float Fz = F * dz / dist;
-
-                float ax_i = Fx / objetos[i].masa;
-                float ay_i = Fy / objetos[i].masa;
-                float az_i = Fz / objetos[i].masa;
-
-                float ax_j = -Fx / objetos[j].masa;
-                float ay_j = -Fy / objetos[j].masa;
-                float az_j = -Fz / objetos[j].masa;
-
-                objetos[i].vx += ax_i * dt;
-                objetos[i].vy += ay_i * dt;
-                objetos[i].vz += az_i * dt;
-
-                objetos[j].vx += ax_j * dt;
-                objetos[j].vy += ay_j * dt;
-                objetos[j].vz += az_j * dt;
-            }
-        }
-    }
-}
+    // ARGUMENTOS (ver gravedad/opciones.hpp)
+    Opciones op;
+    op.pasosCheckpoint = 1000;
+    op.pasosTrayectoria = 1;
+    op.rutaEscenario = GRAVEDAD_DIR_ESCENARIOS "/euler.csv";
+    if (!leerOpciones(argc, argv, op)) return -1;
+    configurarPerfilador(op.eventosTraza);
+    NOMBRAR_HILO("principal");
+    // Antes de crear hilos: los contadores se heredan por los que se creen después
+    if (PERFILADOR_ACTIVO && !op.rutaContadores.empty()) iniciarContadores(op.rutaContadores, op.pasosContadores);
 
-// FUNCIÓN PARA CREAR CUERPOS 
-void crearEsfera(std::vector<float> &vertices, std::vector<unsigned int> &indices, int sectorCount, int stackCount){
-    float radius = 1.0f;
-    for (int i = 0; i <= stackCount; i++){
-        float stackAngle = M_PI/2 -i *M_PI / stackCount;
-        float xy = radius * cosf(stackAngle);
-        float z = radius * sinf(stackAngle);
-
-        for(int j= 0; j <= sectorCount; j++){
-            float sectorAngle = j * 2 * M_PI / sectorCount;
-            float x = xy * cosf(sectorAngle);
-            float y = xy * sinf(sectorAngle);
-            vertices.push_back(x);
-            vertices.push_back(y);
-            vertices.push_back(z);
-
-            glm::vec3 normal = glm::normalize(glm::vec3(x,y,z));
-            vertices.push_back(normal.x);
-            vertices.push_back(normal.y);
-            vertices.push_back(normal.z);
-        }
-    }
-    for (int i = 0; i < stackCount; ++i){
-        for (int j = 0; j < sectorCount; ++j){
-            int k1 = i * (sectorCount + 1) + j;
-            int k2 = k1 + sectorCount + 1;
-
-            indices.push_back(k1);
-            indices.push_back(k2);
-            indices.push_back(k1 + 1);
-
-            indices.push_back(k1 + 1);
-            indices.push_back(k2);
-            indices.push_back(k2 + 1);
+    //--------------- INICIALIZACIÓN DE LA VENTANA ---------------------------------
+    // Con --sin-ventana el contexto es EGL con un framebuffer propio y no se toca GLFW
+    const bool sinVentana = op.anchoSinVentana > 0;
+    GLFWwindow* window = nullptr;
+    ContextoSinVentana contextoSinVentana;
+    GLADloadproc cargarGL = (GLADloadproc)glfwGetProcAddress;
+    if (sinVentana) {
+        if (!contextoSinVentana.crear(op.anchoSinVentana, op.altoSinVentana)) return -1;
+        cargarGL = (GLADloadproc)ContextoSinVentana::cargar;
+    } else {
+        if (!glfwInit()) {
+            std::cerr << "Error al inicializar GLFW\n";
+            return -1;
         }
-    }
-}
-
-
-
-
 
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        // Al grabar, las capturas tienen el tamaño del framebuffer al empezar
+        if (!op.rutaCapturas.empty() || !op.rutaVideo.empty()) glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+        window = glfwCreateWindow(1000, 1000, "Simulador 3D", NULL, NULL);
+        if (!window) {
+            std::cerr << "Error al crear la ventana\n";
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
 
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cerr << "Error al inicializar GLAD\n";
+            return -1;
+        }
 
+        glViewport(0, 0, 1000, 1000);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window,mouse_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
+    glEnable(GL_DEPTH_TEST);
 
-int main() {
-        
-    //--------------- INICIALIZACIÓN DE LA VENTANA ---------------------------------
-    if (!glfwInit()) {
-        std::cerr << "Error al inicializar GLFW\n";
+    // ------------------------------------RENDER DE LAS ESFERAS------------------------------------------
+    const bool conImpostores = op.esferas == ModoEsferas::IMPOSTORES;
+    RenderEsferas esferas;
+    RenderImpostores impostores;
+    BufferCamara camara;
+    AnilloInstancias anillo;
+    if (!(conImpostores ? impostores.iniciar() : esferas.iniciar()) || !camara.crear() ||
+        !anillo.crear(cargarGL)) {
+        glfwTerminate();
         return -1;
     }
-
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow* window = glfwCreateWindow(1000, 1000, "Simulador 3D", NULL, NULL);
-    if (!window) {
-        std::cerr << "Error al crear la ventana\n";
+    RecorteCuerpos recorte;
+    RenderEstelas estelas;
+    if (op.longitudEstelas > 0 && !estelas.iniciar(op.longitudEstelas)) {
         glfwTerminate();
         return -1;
     }
-    glfwMakeContextCurrent(window);
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cerr << "Error al inicializar GLAD\n";
+    // CAPTURAS (--capturas / --video): del tamaño del framebuffer al empezar
+    int anchoFb = op.anchoSinVentana, altoFb = op.altoSinVentana;
+    if (window) glfwGetFramebufferSize(window, &anchoFb, &altoFb);
+    GrabadorFrames grabador;
+    if (!op.rutaCapturas.empty() && !grabador.abrir(op.rutaCapturas, FormatoCaptura::PNG, anchoFb, altoFb)) {
+        glfwTerminate();
         return -1;
     }
-
-    glViewport(0, 0, 1000, 1000);
-    glEnable(GL_DEPTH_TEST);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window,mouse_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-    //----------------------------SHADERS DE LAS ESFERAS----------------------------------
-    const char* vertexShaderSource = R"(
-        #version 330 core
-        layout(location = 0) in vec3 aPos;
-        layout(location = 1) in vec3 aNormal;
-
-        out vec3 FragPos;
-        out vec3 Normal;
-
-        uniform mat4 model;
-        uniform mat4 view;
-        uniform mat4 projection;
-
-        void main(){
-            FragPos = vec3(model * vec4(aPos,1.0));
-            Normal = mat3(transpose(inverse(model))) * aNormal;
-            gl_Position = projection * view * vec4(FragPos,1.0);
+    if (!op.rutaVideo.empty() && !grabador.abrir(op.rutaVideo, FormatoCaptura::YUV, anchoFb, altoFb)) {
+        glfwTerminate();
+        return -1;
+    }
+    // Al grabar, cada frame avanza lo mismo: el vídeo va a velocidad real aunque el render no
+    const bool pasoFijo = sinVentana || grabador.abierto();
+
+    Particulas<PrecisionMotor> objetos;
+    Aceleraciones<PrecisionMotor> aceleraciones;
+    aceleraciones.hilos = op.hilos;
+    const Suavizado suavizado(epsSuavizado);
+    MetadatosSnapshot estado;
+
+    if (!op.rutaCargar.empty()) {
+        if (!cargarSnapshot(op.rutaCargar, objetos, &estado)) {
+            glfwTerminate();
+            return -1;
         }
-    )";
-
-    const char* fragmentShaderSource = R"(
-        #version 330 core
-        out vec4 FragColor;
-
-        in vec3 FragPos;
-        in vec3 Normal;
-
-        uniform vec3 objectColor;
-        uniform vec3 lightColor;
-        uniform vec3 lightPos;
-        uniform vec3 viewPos;
-
-        void main(){
-            // Ambient
-            float ambientStrength = 0.2;
-            vec3 ambient = ambientStrength * lightColor;
-
-            // Diffuse
-            vec3 norm = normalize(Normal);
-            vec3 lightDir = normalize(lightPos - FragPos);
-            float diff = max(dot(norm, lightDir), 0.0);
-            vec3 diffuse = diff * lightColor;
-
-            // Specular
-            float specularStrength = 0.5;
-            vec3 viewDir = normalize(viewPos - FragPos);
-            vec3 reflectDir = reflect(-lightDir, norm);
-            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-            vec3 specular = specularStrength * spec * lightColor;
-
-            vec3 result = (ambient + diffuse + specular) * objectColor;
-            FragColor = vec4(result, 1.0);
+    } else {
+        bool ok = op.generador.empty() ? cargarEscenario(op.rutaEscenario, objetos, op.hilos)
+                                       : generarEscena(op.generador, op.cuerposGenerados, op.semilla, G, objetos);
+        if (!ok) {
+            glfwTerminate();
+            return -1;
         }
-    )";
-
-    // Compilar shaders
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader,1,&vertexShaderSource,NULL);
-    glCompileShader(vertexShader);
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader,1,&fragmentShaderSource,NULL);
-    glCompileShader(fragmentShader);
-
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram,vertexShader);
-    glAttachShader(shaderProgram,fragmentShader);
-    glLinkProgram(shaderProgram);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // ------------------------------------GENERAR LAS ESFERAS------------------------------------------
-    std::vector<float> sphereVertices;
-    std::vector<unsigned int> sphereIndices;
-    crearEsfera(sphereVertices,sphereIndices,36,18);
-
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1,&VAO);
-    glGenBuffers(1,&VBO);
-    glGenBuffers(1,&EBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER,VBO);
-    glBufferData(GL_ARRAY_BUFFER,sphereVertices.size()*sizeof(float),&sphereVertices[0],GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO); // Nuevo
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices.size()*sizeof(unsigned int), &sphereIndices[0], GL_STATIC_DRAW); // Nuevo
-
-
-    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)(3*sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Planeta central (masivo)
-    std::vector<Objeto> objetos;
-    objetos.push_back(Objeto(0.0f,0.0f,0.0f, 0.0f,0.0f,0.0f, 0.2f, 1000.0f, glm::vec3(1.0f,0.8f,0.2f)));
-
-    // Planetas satelites
-    float r = 0.6f;
-    float v = sqrt(G * 1000.0f / r);
-    objetos.push_back(Objeto(r,0.0f,0.0f, 0.0f,v,0.0f, 0.05f, 1.0f, glm::vec3(0.2f,0.6f,1.0f)));
+    }
 
+    float lastFrame = 0.0f;
 
+    // REPRODUCCIÓN: los cuerpos de la escena (o del snapshot) solo aportan radio y color
+    const bool reproduciendo = !op.rutaReproducir.empty();
+    ReproductorTrayectoria reproductor;
+    AparienciaCuerpos apariencia;
+    ControlReproduccion control;
+    FrameTrayectoria frame;
+    if (reproduciendo) {
+        if (!reproductor.abrir(op.rutaReproducir)) {
+            glfwTerminate();
+            return -1;
+        }
+        apariencia.desde(objetos);
+    }
 
-    float lastFrame = 0.0f;
+    std::unique_ptr<EscritorCheckpoints<PrecisionMotor>> checkpoints;
+    if (!reproduciendo && !op.rutaCheckpoint.empty()) checkpoints.reset(new EscritorCheckpoints<PrecisionMotor>(op.rutaCheckpoint));
+
+    EscritorTrayectoria trayectoria;
+    if (!reproduciendo && !op.rutaTrayectoria.empty() && !trayectoria.abrir(op.rutaTrayectoria, op.trayectoria)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    // DIAGNÓSTICOS: el potencial se calcula en el mismo paso de fuerzas, solo en los pasos medidos
+    RegistroDiagnosticos diagnosticos;
+    if (!reproduciendo && !op.rutaDiagnosticos.empty() && !diagnosticos.abrir(op.rutaDiagnosticos)) {
+        glfwTerminate();
+        return -1;
+    }
 
     // -------------------------------LOOP DE LA VENTANA-------------------------------------------
-    while(!glfwWindowShouldClose(window)){
-        float currentFrame = glfwGetTime();
-        float deltaTime = currentFrame - lastFrame;
+    uint64_t numFrame = 0;
+    while (!(window && glfwWindowShouldClose(window)) && (op.maxFrames == 0 || numFrame < op.maxFrames)) {
+        ZONA("frame");
+        float currentFrame = pasoFijo ? float(numFrame / op.fpsCaptura) : float(glfwGetTime());
+        float deltaTime = pasoFijo ? float(1.0 / op.fpsCaptura) : currentFrame - lastFrame;
         lastFrame = currentFrame;
+        numFrame++;
 
-        processInput(window, deltaTime);
+        if (window) processInput(window, deltaTime);
 
         glClearColor(0.1f,0.1f,0.1f,1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        gravedadMutua(objetos,G,deltaTime);
-        for(auto &obj:objetos) obj.update(deltaTime);
+        if (reproduciendo) {
+            procesarReproduccion(window, deltaTime, control, reproductor.numFrames(), op.framesPorSegundo);
+            if (reproductor.muestrear(control.posicion, frame)) volcarFrame(frame, apariencia, objetos);
+        } else {
+            ZONA("simulacion");
+            aceleraciones.calcularPotencial = diagnosticos.abierto() && estado.paso % op.pasosDiagnosticos == 0;
+            gravedadMutua(objetos,G,suavizado,Escalar(deltaTime),aceleraciones);
+            if (aceleraciones.calcularPotencial)
+                diagnosticos.escribir(estado.paso, estado.tiempo,
+                                      medirDiagnostico(objetos, aceleraciones, objetos.xPos.data(), objetos.yPos.data(), objetos.zPos.data()));
+            actualizarPosiciones(objetos,Escalar(deltaTime));
+            {
+                ZONA("eliminar escapados");
+                eliminarEscapados(objetos,Escalar(radioEscape));
+            }
+            estado.paso++;
+            estado.tiempo += deltaTime;
+            cerrarPasoContadores(estado.paso);
+            if (checkpoints && estado.paso % op.pasosCheckpoint == 0) checkpoints->solicitar(objetos, estado);
+            if (trayectoria.abierto() && estado.paso % op.pasosTrayectoria == 0) trayectoria.anadirFrame(objetos, estado.tiempo);
+        }
 
 
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f),800.0f/800.0f,0.1f,100.0f);
+        if (window) glfwGetFramebufferSize(window, &anchoFb, &altoFb);
+        const float aspecto = altoFb > 0 ? float(anchoFb) / float(altoFb) : 1.0f;
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspecto, 0.1f, 100.0f);
         glm::mat4 view = glm::lookAt(cameraPos,cameraPos+cameraFront,cameraUp);
 
-        glUseProgram(shaderProgram);
-        glUniform3f(glGetUniformLocation(shaderProgram,"lightPos"),1.2f,1.0f,2.0f);
-        glUniform3f(glGetUniformLocation(shaderProgram,"lightColor"),1.0f,1.0f,1.0f);
-        glUniform3f(glGetUniformLocation(shaderProgram,"viewPos"),cameraPos.x,cameraPos.y,cameraPos.z);
-
-        for(auto &obj:objetos){
-            glm::mat4 model = glm::translate(glm::mat4(1.0f),glm::vec3(obj.xPos,obj.yPos,obj.zPos));
-            model = glm::scale(model,glm::vec3(obj.radius));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram,"model"),1,GL_FALSE,glm::value_ptr(model));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram,"view"),1,GL_FALSE,glm::value_ptr(view));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram,"projection"),1,GL_FALSE,glm::value_ptr(projection));
-            glUniform3fv(glGetUniformLocation(shaderProgram,"objectColor"),1,glm::value_ptr(obj.color));
-
-            glBindVertexArray(VAO);
-            glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0); 
+        DatosCamara datos;
+        {
+            ZONA("uniforms");
+            datos.view = view;
+            datos.projection = projection;
+            datos.lightPos = glm::vec4(1.2f, 1.0f, 2.0f, 1.0f);
+            datos.lightColor = glm::vec4(1.0f);
+            datos.viewPos = glm::vec4(cameraPos, 1.0f);
+            camara.actualizar(datos);
         }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        bool hayInstancias = false;
+        {
+            ZONA("recorte");
+            Frustum frustum = extraerFrustum(datos, float(altoFb), op.radioMinPx);
+            if (!conImpostores) esferas.limitesLod(frustum.radioMaxNivel);
+            // Las instancias visibles se escriben directamente en el buffer de la GPU
+            InstanciaEsfera* destino = anillo.escribir(recorte.clasificar(objetos, frustum, op.hilos));
+            if (destino) recorte.escribir(objetos, destino);
+            hayInstancias = destino && anillo.publicar();
+        }
+
+        {
+            ZONA("dibujar");
+            if (hayInstancias) {
+                if (conImpostores) impostores.dibujar(anillo.buffer(), anillo.primera(), recorte.visibles());
+                else esferas.dibujar(anillo.buffer(), anillo.primera(), recorte.cuentasNivel());
+            }
+            anillo.terminarFrame();
+        }
+
+        if (op.longitudEstelas > 0) {
+            ZONA("estelas");
+            estelas.anadir(objetos);
+            estelas.dibujar();
+        }
+
+        // Antes del swap: después el contenido del back buffer no está definido
+        grabador.capturar(anchoFb, altoFb);
+
+        if (window) {
+            {
+                ZONA("swap");
+                glfwSwapBuffers(window);
+            }
+            {
+                ZONA("eventos");
+                glfwPollEvents();
+            }
+        }
+    }
+
+    if (!reproduciendo && !op.rutaGuardar.empty()) guardarSnapshot(objetos, op.rutaGuardar, estado);
+    trayectoria.cerrar();
+    diagnosticos.cerrar();
+    if (diagnosticos.filas() > 0)
+        std::cout << "Diagnósticos: " << diagnosticos.filas() << " medidas, deriva máxima de energía "
+                  << diagnosticos.errorEnergiaMax() << "\n";
+    if (reproduciendo) {
+        EstadisticasReproduccion st = reproductor.estadisticas();
+        std::cout << "Reproducción: " << st.aciertos << " chunks ya decodificados, " << st.fallos
+                  << " decodificados en el render, " << st.precargados << " precargados\n";
+    }
+    if (checkpoints) {
+        EstadisticasCheckpoint st = checkpoints->estadisticas();
+        std::cout << "Checkpoints: " << st.escritos << " escritos, " << st.omitidos << " omitidos, "
+                  << st.fallidos << " fallidos; copia en el bucle " << st.msCopiaTotal << " ms en total\n";
+    }
+
+    if (!op.rutaCapturas.empty() || !op.rutaVideo.empty()) {
+        grabador.cerrar();
+        std::cout << "Capturas: " << grabador.escritos() << " frames escritos, " << grabador.esperas()
+                  << " frames esperando al disco\n";
+    }
+
+    terminarContadores();
+
+    // TRAZA DEL PERFILADOR (con los hilos de fondo ya parados)
+    if (PERFILADOR_ACTIVO && !op.rutaTraza.empty()) {
+        checkpoints.reset();
+        reproductor.cerrar();
+        exportarTrazaChrome(op.rutaTraza);
+        imprimirResumenPerfilador();
     }
 
-    glDeleteVertexArrays(1,&VAO);
-    glDeleteBuffers(1,&VBO);
+    esferas.destruir();
+    impostores.destruir();
+    anillo.destruir();
+    estelas.destruir();
+    camara.destruir();
+    contextoSinVentana.destruir();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
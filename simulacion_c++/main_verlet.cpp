@@ -3,14 +3,50 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <memory>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+#include <gravedad/integradores.hpp>
+#include <gravedad/checkpoint.hpp>
+#include <gravedad/contadores.hpp>
+#include <gravedad/diagnosticos.hpp>
+#include <gravedad/escenario.hpp>
+#include <gravedad/generadores.hpp>
+#include <gravedad/opciones.hpp>
+#include <gravedad/perfilador.hpp>
+#include <gravedad/reproductor.hpp>
+#include <render/anillo.hpp>
+#include <render/camara.hpp>
+#include <render/esferas.hpp>
+#include <render/estelas.hpp>
+#include <render/grabador.hpp>
+#include <render/impostores.hpp>
+#include <render/interpolacion.hpp>
+#include <render/recorte.hpp>
+#include <render/sin_ventana.hpp>
 
 // CONFIGURACIÓN
 const float G = 0.001f; // constante gravitatoria pequeña
 const float restitution = 1.0f;
-const float fixedDt = 0.001f;
+const float radioEscape = 50.0f; // distancia a partir de la cual un cuerpo se elimina
+const float epsSuavizado = 0.003f; // longitud de suavizado gravitatorio
+
+// PRECISIÓN DEL MOTOR (se puede cambiar con -DGRAVEDAD_PRECISION=... en CMake)
+// Por defecto modo mixto: posiciones y velocidades en double,
+// fuerzas en float relativas al centro de masas
+#ifndef GRAVEDAD_PRECISION
+#define GRAVEDAD_PRECISION PrecisionMixta
+#endif
+using PrecisionMotor = GRAVEDAD_PRECISION;
+using Escalar = PrecisionMotor::Almacen;
+
+// ESCENAS (CMake define la ruta absoluta; sin CMake se buscan en ./escenarios)
+#ifndef GRAVEDAD_DIR_ESCENARIOS
+#define GRAVEDAD_DIR_ESCENARIOS "escenarios"
+#endif
+
+// SUAVIZADO: SuavizadoPlummer, SuavizadoSpline o SuavizadoCorte (ver gravedad/suavizado.hpp)
+using Suavizado = SuavizadoPlummer<PrecisionMotor::Calculo>;
 
 
 // CÁMARA
@@ -22,23 +58,6 @@ float yaw = -90.0f, pitch = 0.0f;
 bool firstMouse = true;
 float sensitivity = 0.001f;
 
-// CLASE OBJETO
-class Objeto {
-public:
-    float xPos, yPos, zPos;
-    float xPrev, yPrev, zPrev; // Posición anterior para Verlet
-    float radius;
-    float masa;
-    glm::vec3 color;
-
-    Objeto(float x, float y, float z, float vx_, float vy_, float vz_, float r, float m, glm::vec3 c)
-        : xPos(x), yPos(y), zPos(z), radius(r), masa(m), color(c) {
-        xPrev = x - vx_ * fixedDt;
-        yPrev = y - vy_ * fixedDt;
-        zPrev = z - vz_ * fixedDt;
-    }
-};
-
 // CALLBACK PARA AJUSTAR VIEWPORT
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
@@ -60,6 +79,42 @@ void processInput(GLFWwindow* window, float deltaTime) {
         glfwSetWindowShouldClose(window, true);
 }
 
+// CONTROLES DE REPRODUCCIÓN (--reproducir)
+// ESPACIO pausa, FLECHAS IZQ/DER avanzan o retroceden rápido, ARRIBA/ABAJO cambian
+// la velocidad, INICIO/FIN saltan al principio o al final
+struct ControlReproduccion {
+    double posicion = 0.0;   // en frames de la trayectoria (fraccionaria: se interpola)
+    double velocidad = 1.0;
+    bool pausa = false;
+    bool espacioAntes = false, arribaAntes = false, abajoAntes = false;
+};
+
+void procesarReproduccion(GLFWwindow* window, float deltaTime, ControlReproduccion& c, uint64_t numFrames, double framesPorSegundo) {
+    // Sin ventana (--sin-ventana) no hay teclas: la reproducción avanza sola
+    auto pulsada = [window](int tecla) { return window && glfwGetKey(window, tecla) == GLFW_PRESS; };
+    bool espacio = pulsada(GLFW_KEY_SPACE);
+    bool arriba = pulsada(GLFW_KEY_UP);
+    bool abajo = pulsada(GLFW_KEY_DOWN);
+    if (espacio && !c.espacioAntes) c.pausa = !c.pausa;
+    if (arriba && !c.arribaAntes) c.velocidad *= 2.0;
+    if (abajo && !c.abajoAntes) c.velocidad *= 0.5;
+    c.espacioAntes = espacio;
+    c.arribaAntes = arriba;
+    c.abajoAntes = abajo;
+
+    if (!c.pausa) c.posicion += c.velocidad * framesPorSegundo * deltaTime;
+
+    // Arrastrar: diez veces la velocidad normal, también en pausa
+    double arrastre = 10.0 * c.velocidad * framesPorSegundo * deltaTime;
+    if (pulsada(GLFW_KEY_RIGHT)) c.posicion += arrastre;
+    if (pulsada(GLFW_KEY_LEFT)) c.posicion -= arrastre;
+    if (pulsada(GLFW_KEY_HOME)) c.posicion = 0.0;
+    if (pulsada(GLFW_KEY_END)) c.posicion = double(numFrames - 1);
+
+    if (c.posicion < 0.0) c.posicion = 0.0;
+    if (c.posicion > double(numFrames - 1)) c.posicion = double(numFrames - 1);
+}
+
 // USAR EL MOUSE PARA MOVER LA CAMARA
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     if (firstMouse) {
@@ -89,294 +144,318 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     cameraFront = glm::normalize(front);
 }
 
-// FUNCIÓN PARA CALCULAR LAS ACELERACIONES DE TODOS LOS OBJETOS EN UN INSTANTE DE TIEMPO
-std::vector<glm::vec3> calcularAceleraciones(const std::vector<Objeto>& objetos) {
-    std::vector<glm::vec3> aceleraciones(objetos.size(), glm::vec3(0.0f));
+int main(int argc, char** argv) {
 
-    for (size_t i = 0; i < objetos.size(); ++i) {
-        for (size_t j = i + 1; j < objetos.size(); ++j) {
-            float dx = objetos[j].xPos - objetos[i].xPos;
-            float dy = objetos[j].yPos - objetos[i].yPos;
-            float dz = objetos[j].zPos - objetos[i].zPos;
-            float distSq = dx * dx + dy * dy + dz * dz;
+    // ARGUMENTOS (ver gravedad/opciones.hpp)
+    Opciones op;
+    op.pasosCheckpoint = 10000;
+    op.pasosTrayectoria = 100;
+    op.rutaEscenario = GRAVEDAD_DIR_ESCENARIOS "/verlet.csv";
+    if (!leerOpciones(argc, argv, op)) return -1;
+    const double fixedDt = op.dtFijo;
+    configurarPerfilador(op.eventosTraza);
+    NOMBRAR_HILO("principal");
+    // Antes de crear hilos: los contadores se heredan por los que se creen después
+    if (PERFILADOR_ACTIVO && !op.rutaContadores.empty()) iniciarContadores(op.rutaContadores, op.pasosContadores);
 
-            if (distSq > 0.00001f) {
-                float dist = sqrt(distSq);
-                float F = G * objetos[i].masa * objetos[j].masa / distSq;
-
-                float Fx = F * dx / dist;
-                float Fy = F * dy / dist;
-                float Fz = F * dz / dist;
-
-                aceleraciones[i].x += Fx / objetos[i].masa;
-                aceleraciones[i].y += Fy / objetos[i].masa;
-                aceleraciones[i].z += Fz / objetos[i].masa;
-
-                aceleraciones[j].x -= Fx / objetos[j].masa;
-                aceleraciones[j].y -= Fy / objetos[j].masa;
-                aceleraciones[j].z -= Fz / objetos[j].masa;
-            }
+    //--------------- INICIALIZACIÓN DE LA VENTANA ---------------------------------
+    // Con --sin-ventana el contexto es EGL con un framebuffer propio y no se toca GLFW
+    const bool sinVentana = op.anchoSinVentana > 0;
+    GLFWwindow* window = nullptr;
+    ContextoSinVentana contextoSinVentana;
+    GLADloadproc cargarGL = (GLADloadproc)glfwGetProcAddress;
+    if (sinVentana) {
+        if (!contextoSinVentana.crear(op.anchoSinVentana, op.altoSinVentana)) return -1;
+        cargarGL = (GLADloadproc)ContextoSinVentana::cargar;
+    } else {
+        if (!glfwInit()) {
+            std::cerr << "Error al inicializar GLFW\n";
+            return -1;
         }
-    }
-    return aceleraciones;
-}
 
-// FUNCIÓN PRINCOPAL DE ACTUALIZACIÓN DEL MÉTODO DE VERLET
-void gravedadVerlet(std::vector<Objeto>& objetos, float dt) {
-    std::vector<glm::vec3> aceleraciones = calcularAceleraciones(objetos);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        // Al grabar, las capturas tienen el tamaño del framebuffer al empezar
+        if (!op.rutaCapturas.empty() || !op.rutaVideo.empty()) glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+        window = glfwCreateWindow(1000, 1000, "Simulador 3D", NULL, NULL);
+        if (!window) {
+            std::cerr << "Error al crear la ventana\n";
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
 
-    for (size_t i = 0; i < objetos.size(); ++i) {
-        float tempX = objetos[i].xPos;
-        float tempY = objetos[i].yPos;
-        float tempZ = objetos[i].zPos;
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cerr << "Error al inicializar GLAD\n";
+            return -1;
+        }
 
-        objetos[i].xPos = 2.0f * objetos[i].xPos - objetos[i].xPrev + aceleraciones[i].x * dt * dt;
-        objetos[i].yPos = 2.0f * objetos[i].yPos - objetos[i].yPrev + aceleraciones[i].y * dt * dt;
-        objetos[i].zPos = 2.0f * objetos[i].zPos - objetos[i].zPrev + aceleraciones[i].z * dt * dt;
+        glViewport(0, 0, 1000, 1000);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
+    glEnable(GL_DEPTH_TEST);
 
-        objetos[i].xPrev = tempX;
-        objetos[i].yPrev = tempY;
-        objetos[i].zPrev = tempZ;
+    // ------------------------------------RENDER DE LAS ESFERAS------------------------------------------
+    const bool conImpostores = op.esferas == ModoEsferas::IMPOSTORES;
+    RenderEsferas esferas;
+    RenderImpostores impostores;
+    BufferCamara camara;
+    AnilloInstancias anillo;
+    if (!(conImpostores ? impostores.iniciar() : esferas.iniciar()) || !camara.crear() ||
+        !anillo.crear(cargarGL)) {
+        glfwTerminate();
+        return -1;
+    }
+    RecorteCuerpos recorte;
+    RenderEstelas estelas;
+    if (op.longitudEstelas > 0 && !estelas.iniciar(op.longitudEstelas)) {
+        glfwTerminate();
+        return -1;
     }
-}
 
-// FUNCIÓN PARA CREAR CUERPOS 
-void crearEsfera(std::vector<float>& vertices, std::vector<unsigned int> &indices, int sectorCount, int stackCount) {
-    float radius = 1.0f;
-    for (int i = 0; i <= stackCount; i++) {
-        float stackAngle = M_PI / 2 - i * M_PI / stackCount;
-        float xy = radius * cosf(stackAngle);
-        float z = radius * sinf(stackAngle);
-
-        for (int j = 0; j <= sectorCount; j++) {
-            float sectorAngle = j * 2 * M_PI / sectorCount;
-            float x = xy * cosf(sectorAngle);
-            float y = xy * sinf(sectorAngle);
-            vertices.push_back(x);
-            vertices.push_back(y);
-            vertices.push_back(z);
-
-            glm::vec3 normal = glm::normalize(glm::vec3(x, y, z));
-            vertices.push_back(normal.x);
-            vertices.push_back(normal.y);
-            vertices.push_back(normal.z);
-        }
+    // CAPTURAS (--capturas / --video): del tamaño del framebuffer al empezar
+    int anchoFb = op.anchoSinVentana, altoFb = op.altoSinVentana;
+    if (window) glfwGetFramebufferSize(window, &anchoFb, &altoFb);
+    GrabadorFrames grabador;
+    if (!op.rutaCapturas.empty() && !grabador.abrir(op.rutaCapturas, FormatoCaptura::PNG, anchoFb, altoFb)) {
+        glfwTerminate();
+        return -1;
     }
-    for (int i = 0; i < stackCount; ++i){
-        for (int j = 0; j < sectorCount; ++j){
-            int k1 = i * (sectorCount + 1) + j;
-            int k2 = k1 + sectorCount + 1;
-
-            // 2 triangulos por sector
-            indices.push_back(k1);
-            indices.push_back(k2);
-            indices.push_back(k1 + 1);
-
-            indices.push_back(k1 + 1);
-            indices.push_back(k2);
-            indices.push_back(k2 + 1);
+    if (!op.rutaVideo.empty() && !grabador.abrir(op.rutaVideo, FormatoCaptura::YUV, anchoFb, altoFb)) {
+        glfwTerminate();
+        return -1;
+    }
+    // Al grabar, cada frame avanza lo mismo: el vídeo va a velocidad real aunque el render no
+    const bool pasoFijo = sinVentana || grabador.abierto();
+
+    Particulas<PrecisionMotor> objetos;
+    Aceleraciones<PrecisionMotor> aceleraciones;
+    aceleraciones.hilos = op.hilos;
+    const Suavizado suavizado(epsSuavizado);
+    MetadatosSnapshot estado;
+
+    if (!op.rutaCargar.empty()) {
+        if (!cargarSnapshot(op.rutaCargar, objetos, &estado)) {
+            glfwTerminate();
+            return -1;
         }
+    } else {
+        bool ok = op.generador.empty() ? cargarEscenario(op.rutaEscenario, objetos, op.hilos)
+                                       : generarEscena(op.generador, op.cuerposGenerados, op.semilla, G, objetos);
+        if (!ok) {
+            glfwTerminate();
+            return -1;
+        }
+        prepararVerlet(objetos, Escalar(fixedDt));
     }
-}
-
-
-
-
-
 
-
-
-
-
-int main() {
-
-    //--------------- INICIALIZACIÓN DE LA VENTANA ---------------------------------
-    if (!glfwInit()) {
-        std::cerr << "Error al inicializar GLFW\n";
-        return -1;
+    float lastFrame = 0.0f;
+    double acumulador = estado.acumulador; // al reanudar, el resto exacto del checkpoint
+    // Frames que no cupieron en el presupuesto de subpasos y tiempo simulado que se perdió
+    uint64_t framesAtrasados = 0;
+    double tiempoDescartado = 0.0;
+    CuerposInterpolados<PrecisionMotor> dibujo(objetos);
+
+    // REPRODUCCIÓN: los cuerpos de la escena (o del snapshot) solo aportan radio y color
+    const bool reproduciendo = !op.rutaReproducir.empty();
+    ReproductorTrayectoria reproductor;
+    AparienciaCuerpos apariencia;
+    ControlReproduccion control;
+    FrameTrayectoria frame;
+    if (reproduciendo) {
+        if (!reproductor.abrir(op.rutaReproducir)) {
+            glfwTerminate();
+            return -1;
+        }
+        apariencia.desde(objetos);
     }
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    std::unique_ptr<EscritorCheckpoints<PrecisionMotor>> checkpoints;
+    if (!reproduciendo && !op.rutaCheckpoint.empty()) checkpoints.reset(new EscritorCheckpoints<PrecisionMotor>(op.rutaCheckpoint));
 
-    GLFWwindow* window = glfwCreateWindow(1000, 1000, "Simulador 3D", NULL, NULL);
-    if (!window) {
-        std::cerr << "Error al crear la ventana\n";
+    EscritorTrayectoria trayectoria;
+    if (!reproduciendo && !op.rutaTrayectoria.empty() && !trayectoria.abrir(op.rutaTrayectoria, op.trayectoria)) {
         glfwTerminate();
         return -1;
     }
-    glfwMakeContextCurrent(window);
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cerr << "Error al inicializar GLAD\n";
+    // DIAGNÓSTICOS: el potencial se calcula en el mismo paso de fuerzas, solo en los pasos medidos
+    RegistroDiagnosticos diagnosticos;
+    if (!reproduciendo && !op.rutaDiagnosticos.empty() && !diagnosticos.abrir(op.rutaDiagnosticos)) {
+        glfwTerminate();
         return -1;
     }
 
-    glViewport(0, 0, 1000, 1000);
-    glEnable(GL_DEPTH_TEST);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    // -------------------------------LOOP DE LA VENTANA-------------------------------------------
+    uint64_t numFrame = 0;
+    // Sin contar la carga: si no, el primer frame ya llegaría tarde
+    if (window) lastFrame = float(glfwGetTime());
+    while (!(window && glfwWindowShouldClose(window)) && (op.maxFrames == 0 || numFrame < op.maxFrames)) {
+        ZONA("frame");
+        float currentFrame = pasoFijo ? float(numFrame / op.fpsCaptura) : float(glfwGetTime());
+        float deltaTime = pasoFijo ? float(1.0 / op.fpsCaptura) : currentFrame - lastFrame;
+        lastFrame = currentFrame;
+        numFrame++;
+
+        if (reproduciendo) {
+            procesarReproduccion(window, deltaTime, control, reproductor.numFrames(), op.framesPorSegundo);
+            if (reproductor.muestrear(control.posicion, frame)) volcarFrame(frame, apariencia, objetos);
+        } else {
+            ZONA("simulacion");
+            acumulador += deltaTime;
+
+            // Como mucho op.maxSubpasos por frame: si un frame llega tarde, recuperar todo
+            // el retraso haría el siguiente aún más lento y la aplicación acabaría parada
+            unsigned subpasos = 0;
+            while (acumulador >= fixedDt && subpasos < op.maxSubpasos) {
+                ZONA("subpaso");
+                subpasos++;
+                aceleraciones.calcularPotencial = diagnosticos.abierto() && estado.paso % op.pasosDiagnosticos == 0;
+                gravedadVerlet(objetos, G, suavizado, Escalar(fixedDt), aceleraciones);
+                if (aceleraciones.calcularPotencial)
+                    diagnosticos.escribir(estado.paso, estado.tiempo,
+                                          medirDiagnostico(objetos, aceleraciones, objetos.xPrev.data(),
+                                                           objetos.yPrev.data(), objetos.zPrev.data()));
+                acumulador -= fixedDt;
+                estado.paso++;
+                estado.tiempo += fixedDt;
+                cerrarPasoContadores(estado.paso);
+
+                if (checkpoints && estado.paso % op.pasosCheckpoint == 0) {
+                    estado.acumulador = acumulador;
+                    checkpoints->solicitar(objetos, estado);
+                }
+                if (trayectoria.abierto() && estado.paso % op.pasosTrayectoria == 0)
+                    trayectoria.anadirFrame(objetos, estado.tiempo);
+            }
+            if (acumulador >= fixedDt) {
+                // Lo que no cupo se descarta: la simulación va más lenta que el tiempo real
+                const double descartado = acumulador - std::fmod(acumulador, fixedDt);
+                acumulador -= descartado;
+                tiempoDescartado += descartado;
+                if (framesAtrasados++ == 0)
+                    std::cerr << "Aviso: la simulación no llega al tiempo real (más de " << op.maxSubpasos
+                              << " pasos de " << fixedDt << " s por frame); el retraso se descarta\n";
+            }
+            ZONA("eliminar escapados");
+            eliminarEscapados(objetos, Escalar(radioEscape));
+        }
 
+        // Posiciones entre el penúltimo y el último paso (en reproducción, tal cual)
+        dibujo.interpolar(objetos, reproduciendo ? Escalar(1) : Escalar(acumulador / fixedDt), op.hilos);
 
-    //----------------------------SHADERS DE LAS ESFERAS----------------------------------
-    const char* vertexShaderSource = R"(
-        #version 330 core
-        layout(location = 0) in vec3 aPos;
-        layout(location = 1) in vec3 aNormal;
+        if (window) processInput(window, deltaTime);
 
-        out vec3 FragPos;
-        out vec3 Normal;
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        uniform mat4 model;
-        uniform mat4 view;
-        uniform mat4 projection;
 
-        void main(){
-            FragPos = vec3(model * vec4(aPos,1.0));
-            Normal = mat3(transpose(inverse(model))) * aNormal;
-            gl_Position = projection * view * vec4(FragPos,1.0);
-        }
-    )";
-
-    const char* fragmentShaderSource = R"(
-        #version 330 core
-        out vec4 FragColor;
-
-        in vec3 FragPos;
-        in vec3 Normal;
-
-        uniform vec3 objectColor;
-        uniform vec3 lightColor;
-        uniform vec3 lightPos;
-        uniform vec3 viewPos;
-
-        void main(){
-            // Ambient
-            float ambientStrength = 0.2;
-            vec3 ambient = ambientStrength * lightColor;
-
-            // Diffuse
-            vec3 norm = normalize(Normal);
-            vec3 lightDir = normalize(lightPos - FragPos);
-            float diff = max(dot(norm, lightDir), 0.0);
-            vec3 diffuse = diff * lightColor;
-
-            // Specular
-            float specularStrength = 0.5;
-            vec3 viewDir = normalize(viewPos - FragPos);
-            vec3 reflectDir = reflect(-lightDir, norm);
-            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-            vec3 specular = specularStrength * spec * lightColor;
-
-            vec3 result = (ambient + diffuse + specular) * objectColor;
-            FragColor = vec4(result, 1.0);
+        if (window) glfwGetFramebufferSize(window, &anchoFb, &altoFb);
+        const float aspecto = altoFb > 0 ? float(anchoFb) / float(altoFb) : 1.0f;
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspecto, 0.1f, 100.0f);
+        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+
+        DatosCamara datos;
+        {
+            ZONA("uniforms");
+            datos.view = view;
+            datos.projection = projection;
+            datos.lightPos = glm::vec4(1.2f, 1.0f, 2.0f, 1.0f);
+            datos.lightColor = glm::vec4(1.0f);
+            datos.viewPos = glm::vec4(cameraPos, 1.0f);
+            camara.actualizar(datos);
         }
-    )";
-
-    // Compilar shaders
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // ------------------------------------GENERAR LAS ESFERAS------------------------------------------
-    std::vector<float> sphereVertices;
-    std::vector<unsigned int> sphereIndices;
-    crearEsfera(sphereVertices,sphereIndices, 36, 18);
-
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sphereVertices.size() * sizeof(float), &sphereVertices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices.size()*sizeof(unsigned int), &sphereIndices[0], GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Planeta central (masivo)
-    std::vector<Objeto> objetos;
-    objetos.push_back(Objeto(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.2f, 1000.0f, glm::vec3(1.0f, 0.8f, 0.2f)));
-
-    // Planetas satelites
-    float r1 = 0.6f;
-    float v1 = sqrt(G * 1000.0f / r1);
-    objetos.push_back(Objeto(r1, 0.0f, 0.0f, 0.0f, v1, 0.0f, 0.05f, 1.0f, glm::vec3(0.2f, 0.6f, 1.0f)));
-
-    float r2 = 0.8f;
-    float v2 = sqrt(G * 1000.0f / r2);
-    objetos.push_back(Objeto(0.0f, r2, 0.0f, -v2, 0.0f, 0.0f, 0.03f, 0.5f, glm::vec3(1.0f, 0.2f, 0.2f)));
-
-    float r3 = 1.0f;
-    float v3 = sqrt(G * 1000.0f / r3);
-    objetos.push_back(Objeto(0.0f, 0.0f, r3, v3, 0.0f, 0.0f, 0.04f, 2.0f, glm::vec3(0.8f, 0.8f, 0.8f)));
-
-
-    
-    float lastFrame = 0.0f;
-    static float acumulador = 0.0f;
 
-    // -------------------------------LOOP DE LA VENTANA-------------------------------------------
-    while (!glfwWindowShouldClose(window)) {
-        float currentFrame = glfwGetTime();
-        float deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+        bool hayInstancias = false;
+        {
+            ZONA("recorte");
+            Frustum frustum = extraerFrustum(datos, float(altoFb), op.radioMinPx);
+            if (!conImpostores) esferas.limitesLod(frustum.radioMaxNivel);
+            // Las instancias visibles se escriben directamente en el buffer de la GPU
+            InstanciaEsfera* destino = anillo.escribir(recorte.clasificar(dibujo, frustum, op.hilos));
+            if (destino) recorte.escribir(dibujo, destino);
+            hayInstancias = destino && anillo.publicar();
+        }
 
-        acumulador += deltaTime;
+        {
+            ZONA("dibujar");
+            if (hayInstancias) {
+                if (conImpostores) impostores.dibujar(anillo.buffer(), anillo.primera(), recorte.visibles());
+                else esferas.dibujar(anillo.buffer(), anillo.primera(), recorte.cuentasNivel());
+            }
+            anillo.terminarFrame();
+        }
 
-        while(acumulador >= fixedDt){
-            gravedadVerlet(objetos, fixedDt);
-            acumulador -= fixedDt;
+        if (op.longitudEstelas > 0) {
+            ZONA("estelas");
+            estelas.anadir(dibujo);
+            estelas.dibujar();
         }
 
-        processInput(window, deltaTime);
+        // Antes del swap: después el contenido del back buffer no está definido
+        grabador.capturar(anchoFb, altoFb);
 
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (window) {
+            {
+                ZONA("swap");
+                glfwSwapBuffers(window);
+            }
+            {
+                ZONA("eventos");
+                glfwPollEvents();
+            }
+        }
+    }
 
+    if (!reproduciendo && !op.rutaGuardar.empty()) {
+        estado.acumulador = acumulador;
+        guardarSnapshot(objetos, op.rutaGuardar, estado);
+    }
+    trayectoria.cerrar();
+    diagnosticos.cerrar();
+    if (diagnosticos.filas() > 0)
+        std::cout << "Diagnósticos: " << diagnosticos.filas() << " medidas, deriva máxima de energía "
+                  << diagnosticos.errorEnergiaMax() << "\n";
+    if (reproduciendo) {
+        EstadisticasReproduccion st = reproductor.estadisticas();
+        std::cout << "Reproducción: " << st.aciertos << " chunks ya decodificados, " << st.fallos
+                  << " decodificados en el render, " << st.precargados << " precargados\n";
+    }
+    if (checkpoints) {
+        EstadisticasCheckpoint st = checkpoints->estadisticas();
+        std::cout << "Checkpoints: " << st.escritos << " escritos, " << st.omitidos << " omitidos, "
+                  << st.fallidos << " fallidos; copia en el bucle " << st.msCopiaTotal << " ms en total\n";
+    }
 
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 800.0f, 0.1f, 100.0f);
-        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+    if (framesAtrasados > 0)
+        std::cout << "Paso fijo: " << framesAtrasados << " frames al límite de " << op.maxSubpasos
+                  << " subpasos, " << tiempoDescartado << " s de simulación descartados\n";
+    if (!op.rutaCapturas.empty() || !op.rutaVideo.empty()) {
+        grabador.cerrar();
+        std::cout << "Capturas: " << grabador.escritos() << " frames escritos, " << grabador.esperas()
+                  << " frames esperando al disco\n";
+    }
 
-        glUseProgram(shaderProgram);
-        glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), 1.2f, 1.0f, 2.0f);
-        glUniform3f(glGetUniformLocation(shaderProgram, "lightColor"), 1.0f, 1.0f, 1.0f);
-        glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
-
-        for (auto& obj : objetos) {
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(obj.xPos, obj.yPos, obj.zPos));
-            model = glm::scale(model, glm::vec3(obj.radius));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-            glUniform3fv(glGetUniformLocation(shaderProgram, "objectColor"), 1, glm::value_ptr(obj.color));
-
-            glBindVertexArray(VAO);
-            glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0); 
-        }
+    terminarContadores();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    // TRAZA DEL PERFILADOR (con los hilos de fondo ya parados)
+    if (PERFILADOR_ACTIVO && !op.rutaTraza.empty()) {
+        checkpoints.reset();
+        reproductor.cerrar();
+        exportarTrazaChrome(op.rutaTraza);
+        imprimirResumenPerfilador();
     }
 
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    esferas.destruir();
+    impostores.destruir();
+    anillo.destruir();
+    estelas.destruir();
+    camara.destruir();
+    contextoSinVentana.destruir();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
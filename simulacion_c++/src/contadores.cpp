@@ -0,0 +1,282 @@
+#include <gravedad/contadores.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* const NOMBRES_CONTADORES[NUM_CONTADORES] = {
+    "ciclos", "instrucciones", "refs_cache", "fallos_cache", "ramas", "fallos_rama",
+    "flops", "tarea_ns", "fallos_pagina",
+};
+
+namespace {
+
+// UN DESCRIPTOR ABIERTO: suma peso × valor en su contador lógico
+struct Descriptor {
+    int fd;
+    ContadorHw destino;
+    uint64_t peso;
+};
+
+struct TotalZona {
+    const char* nombre;
+    uint64_t llamadas = 0;
+    uint64_t llamadasPaso = 0;
+    LecturaContadores total;
+    LecturaContadores paso; // desde el último cerrarPasoContadores
+};
+
+struct MuestraPaso {
+    uint64_t paso;
+    std::vector<TotalZona> zonas;
+};
+
+struct EstadoContadores {
+    bool activos = false;
+    std::thread::id hilo;
+    std::vector<Descriptor> descriptores;
+    bool disponible[NUM_CONTADORES] = {};
+    std::string rutaJson;
+    uint64_t pasosPorMuestra = 1;
+    std::vector<TotalZona> zonas;
+    std::vector<MuestraPaso> muestras;
+};
+
+EstadoContadores estado;
+
+#ifdef __linux__
+int abrirEvento(uint32_t tipo, uint64_t config, int lider) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = tipo;
+    attr.config = config;
+    attr.inherit = 1;           // incluye los hilos creados después
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, lider, 0));
+}
+
+bool esIntel() {
+    std::ifstream f("/proc/cpuinfo");
+    std::string linea;
+    while (std::getline(f, linea))
+        if (linea.compare(0, 9, "vendor_id") == 0) return linea.find("GenuineIntel") != std::string::npos;
+    return false;
+}
+
+// GRUPO DE CONTADORES: se programan juntos (misma ventana de medida para los cocientes).
+// Si el líder no abre, se descarta el grupo entero; si falla un miembro, solo ese.
+struct EventoGrupo {
+    uint32_t tipo;
+    uint64_t config;
+    ContadorHw destino;
+    uint64_t peso;
+};
+
+void abrirGrupo(const std::vector<EventoGrupo>& eventos) {
+    int lider = -1;
+    for (const EventoGrupo& e : eventos) {
+        int fd = abrirEvento(e.tipo, e.config, lider);
+        if (fd < 0) {
+            if (lider < 0) return;
+            continue;
+        }
+        if (lider < 0) lider = fd;
+        estado.descriptores.push_back({fd, e.destino, e.peso});
+        estado.disponible[e.destino] = true;
+    }
+}
+#endif
+
+TotalZona& zonaDe(std::vector<TotalZona>& zonas, const char* nombre) {
+    for (TotalZona& z : zonas)
+        if (z.nombre == nombre) return z;
+    zonas.push_back(TotalZona());
+    zonas.back().nombre = nombre;
+    return zonas.back();
+}
+
+void escribirContadoresJson(std::ostream& f, const LecturaContadores& l) {
+    f << "{";
+    bool primero = true;
+    for (int c = 0; c < NUM_CONTADORES; ++c) {
+        if (!estado.disponible[c]) continue;
+        f << (primero ? "" : ", ") << "\"" << NOMBRES_CONTADORES[c] << "\": " << l.valor[c];
+        primero = false;
+    }
+    f << "}";
+}
+
+double cociente(uint64_t a, uint64_t b) { return b ? double(a) / double(b) : 0.0; }
+
+bool escribirJson() {
+    std::ofstream f(estado.rutaJson);
+    if (!f) {
+        std::cerr << "Error al crear el informe de contadores " << estado.rutaJson << "\n";
+        return false;
+    }
+    f << "{\n  \"contadores\": [";
+    bool primero = true;
+    for (int c = 0; c < NUM_CONTADORES; ++c) {
+        if (!estado.disponible[c]) continue;
+        f << (primero ? "" : ", ") << "\"" << NOMBRES_CONTADORES[c] << "\"";
+        primero = false;
+    }
+    f << "],\n  \"zonas\": {\n";
+    for (size_t i = 0; i < estado.zonas.size(); ++i) {
+        const TotalZona& z = estado.zonas[i];
+        f << "    \"" << z.nombre << "\": {\"llamadas\": " << z.llamadas << ", \"total\": ";
+        escribirContadoresJson(f, z.total);
+        if (estado.disponible[CONT_CICLOS] && estado.disponible[CONT_INSTRUCCIONES])
+            f << ", \"ipc\": " << cociente(z.total.valor[CONT_INSTRUCCIONES], z.total.valor[CONT_CICLOS]);
+        f << "}" << (i + 1 < estado.zonas.size() ? "," : "") << "\n";
+    }
+    f << "  },\n  \"pasos\": [\n";
+    for (size_t i = 0; i < estado.muestras.size(); ++i) {
+        const MuestraPaso& m = estado.muestras[i];
+        f << "    {\"paso\": " << m.paso;
+        for (const TotalZona& z : m.zonas) {
+            if (z.llamadasPaso == 0) continue;
+            f << ", \"" << z.nombre << "\": ";
+            escribirContadoresJson(f, z.paso);
+        }
+        f << "}" << (i + 1 < estado.muestras.size() ? "," : "") << "\n";
+    }
+    f << "  ]\n}\n";
+    if (!f) {
+        std::cerr << "Error al escribir el informe de contadores " << estado.rutaJson << "\n";
+        return false;
+    }
+    return true;
+}
+
+void imprimirResumen() {
+    // Todo por llamada salvo los cocientes; CPU ms suma los hilos de la zona
+    std::printf("%-24s %10s %12s %14s %6s %14s %12s %10s\n", "zona", "llamadas", "CPU ms", "ciclos/llamada",
+                "IPC", "fallos cache", "fallos rama", "GFLOP/s");
+    for (const TotalZona& z : estado.zonas) {
+        const uint64_t* v = z.total.valor;
+        char cpu[32] = "-", ciclos[32] = "-", ipc[16] = "-", cache[32] = "-", rama[32] = "-", gflops[32] = "-";
+        if (estado.disponible[CONT_TAREA_NS])
+            std::snprintf(cpu, sizeof(cpu), "%.3f", 1e-6 * cociente(v[CONT_TAREA_NS], z.llamadas));
+        if (estado.disponible[CONT_CICLOS])
+            std::snprintf(ciclos, sizeof(ciclos), "%.0f", cociente(v[CONT_CICLOS], z.llamadas));
+        if (estado.disponible[CONT_CICLOS] && estado.disponible[CONT_INSTRUCCIONES])
+            std::snprintf(ipc, sizeof(ipc), "%.2f", cociente(v[CONT_INSTRUCCIONES], v[CONT_CICLOS]));
+        if (estado.disponible[CONT_FALLOS_CACHE])
+            std::snprintf(cache, sizeof(cache), "%.0f", cociente(v[CONT_FALLOS_CACHE], z.llamadas));
+        if (estado.disponible[CONT_FALLOS_RAMA] && estado.disponible[CONT_RAMAS])
+            std::snprintf(rama, sizeof(rama), "%.2f%%", 100.0 * cociente(v[CONT_FALLOS_RAMA], v[CONT_RAMAS]));
+        if (estado.disponible[CONT_FLOPS])
+            std::snprintf(gflops, sizeof(gflops), "%.2f", cociente(v[CONT_FLOPS], v[CONT_TAREA_NS]));
+        std::printf("%-24s %10llu %12s %14s %6s %14s %12s %10s\n", z.nombre, (unsigned long long)z.llamadas, cpu,
+                    ciclos, ipc, cache, rama, gflops);
+    }
+}
+
+} // namespace
+
+bool iniciarContadores(const std::string& rutaJson, uint64_t pasosPorMuestra) {
+#ifdef __linux__
+    terminarContadores();
+    estado = EstadoContadores();
+    estado.rutaJson = rutaJson;
+    estado.pasosPorMuestra = pasosPorMuestra ? pasosPorMuestra : 1;
+
+    abrirGrupo({{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, CONT_CICLOS, 1},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, CONT_INSTRUCCIONES, 1},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, CONT_REFS_CACHE, 1},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, CONT_FALLOS_CACHE, 1}});
+    abrirGrupo({{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, CONT_RAMAS, 1},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, CONT_FALLOS_RAMA, 1}});
+    // FP_ARITH_INST_RETIRED (evento 0xC7): cada máscara agrupa anchos con el mismo número de FLOPs
+    if (estado.disponible[CONT_CICLOS] && esIntel())
+        abrirGrupo({{PERF_TYPE_RAW, 0x03c7, CONT_FLOPS, 1},    // escalar simple y doble
+                    {PERF_TYPE_RAW, 0x04c7, CONT_FLOPS, 2},    // 128 bits doble
+                    {PERF_TYPE_RAW, 0x18c7, CONT_FLOPS, 4},    // 128 bits simple, 256 bits doble
+                    {PERF_TYPE_RAW, 0x60c7, CONT_FLOPS, 8},    // 256 bits simple, 512 bits doble
+                    {PERF_TYPE_RAW, 0x80c7, CONT_FLOPS, 16}}); // 512 bits simple
+    abrirGrupo({{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, CONT_TAREA_NS, 1},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, CONT_FALLOS_PAGINA, 1}});
+
+    if (estado.descriptores.empty()) {
+        std::cerr << "Error al abrir los contadores de rendimiento (perf_event_open: " << std::strerror(errno)
+                  << "; ver /proc/sys/kernel/perf_event_paranoid)\n";
+        return false;
+    }
+    std::string faltan;
+    for (int c = 0; c < NUM_CONTADORES; ++c)
+        if (!estado.disponible[c]) faltan += std::string(faltan.empty() ? "" : ", ") + NOMBRES_CONTADORES[c];
+    if (!faltan.empty()) std::cerr << "Contadores no disponibles en esta máquina: " << faltan << "\n";
+
+    estado.hilo = std::this_thread::get_id();
+    estado.activos = true;
+    return true;
+#else
+    (void)rutaJson;
+    (void)pasosPorMuestra;
+    std::cerr << "Los contadores de rendimiento solo están disponibles en Linux\n";
+    return false;
+#endif
+}
+
+bool contadoresActivos() { return estado.activos && std::this_thread::get_id() == estado.hilo; }
+
+bool contadorDisponible(ContadorHw c) { return estado.disponible[c]; }
+
+void leerContadores(LecturaContadores& l) {
+    l = LecturaContadores();
+#ifdef __linux__
+    for (const Descriptor& d : estado.descriptores) {
+        uint64_t datos[3]; // valor, tiempo habilitado, tiempo contando
+        if (read(d.fd, datos, sizeof(datos)) != ssize_t(sizeof(datos)) || datos[2] == 0) continue;
+        // Multiplexado: se extrapola al tiempo que estuvo habilitado
+        uint64_t v = datos[2] < datos[1] ? uint64_t(double(datos[0]) * double(datos[1]) / double(datos[2])) : datos[0];
+        l.valor[d.destino] += d.peso * v;
+    }
+#endif
+}
+
+void acumularZonaContadores(const char* nombre, const LecturaContadores& inicio, const LecturaContadores& fin) {
+    TotalZona& z = zonaDe(estado.zonas, nombre);
+    z.llamadas++;
+    z.llamadasPaso++;
+    for (int c = 0; c < NUM_CONTADORES; ++c) {
+        // Con multiplexado la extrapolación puede retroceder un poco
+        uint64_t d = fin.valor[c] > inicio.valor[c] ? fin.valor[c] - inicio.valor[c] : 0;
+        z.total.valor[c] += d;
+        z.paso.valor[c] += d;
+    }
+}
+
+void cerrarPasoContadores(uint64_t paso) {
+    if (!contadoresActivos()) return;
+    if (paso % estado.pasosPorMuestra == 0) estado.muestras.push_back({paso, estado.zonas});
+    for (TotalZona& z : estado.zonas) {
+        z.paso = LecturaContadores();
+        z.llamadasPaso = 0;
+    }
+}
+
+void terminarContadores() {
+    if (!estado.activos) return;
+    imprimirResumen();
+    if (!estado.rutaJson.empty()) escribirJson();
+#ifdef __linux__
+    for (const Descriptor& d : estado.descriptores) close(d.fd);
+#endif
+    estado.descriptores.clear();
+    estado.activos = false;
+}
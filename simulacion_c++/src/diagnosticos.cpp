@@ -0,0 +1,37 @@
+#include <gravedad/diagnosticos.hpp>
+
+#include <iostream>
+
+bool RegistroDiagnosticos::abrir(const std::string& ruta_) {
+    cerrar();
+    archivo = std::fopen(ruta_.c_str(), "w");
+    if (!archivo) {
+        std::cerr << "Error al crear el registro de diagnósticos " << ruta_ << "\n";
+        return false;
+    }
+    ruta = ruta_;
+    numFilas = 0;
+    energiaInicial = 0.0;
+    errorMax = 0.0;
+    std::fputs("paso,tiempo,cinetica,potencial,energia,error_energia,px,py,pz,lx,ly,lz,virial\n", archivo);
+    return true;
+}
+
+void RegistroDiagnosticos::escribir(uint64_t paso, double tiempo, const Diagnostico& d) {
+    if (!archivo) return;
+    if (numFilas == 0) energiaInicial = d.energia;
+    const double error = energiaInicial != 0.0 ? std::fabs((d.energia - energiaInicial) / energiaInicial) : 0.0;
+    if (error > errorMax) errorMax = error;
+    std::fprintf(archivo, "%llu,%.9g,%.12g,%.12g,%.12g,%.6g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.6g\n",
+                 (unsigned long long)paso, tiempo, d.cinetica, d.potencial, d.energia, error,
+                 d.px, d.py, d.pz, d.lx, d.ly, d.lz, d.virial);
+    numFilas++;
+}
+
+void RegistroDiagnosticos::cerrar() {
+    if (!archivo) return;
+    bool ok = !std::ferror(archivo);
+    if (std::fclose(archivo) != 0) ok = false;
+    if (!ok) std::cerr << "Error al escribir el registro de diagnósticos " << ruta << "\n";
+    archivo = nullptr;
+}
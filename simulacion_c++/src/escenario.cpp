@@ -0,0 +1,357 @@
+#include <gravedad/escenario.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char MAGIA_SNAPSHOT[8] = {'G', 'R', 'A', 'V', 'S', 'N', 'A', 'P'};
+const size_t MAX_COLUMNAS = 64;
+
+inline bool esEspacio(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool esSeparador(char c) { return c == ',' || c == ';'; }
+
+inline void saltarLinea(const char*& p, const char* fin) {
+    const void* nl = std::memchr(p, '\n', size_t(fin - p));
+    p = nl ? static_cast<const char*>(nl) + 1 : fin;
+}
+
+// Una línea es de datos si tiene algo antes del fin de línea o de un comentario
+inline bool esLineaDatos(const char* p, const char* fin) {
+    while (p < fin && esEspacio(*p)) ++p;
+    return p < fin && *p != '\n' && *p != '#';
+}
+
+// NÚMERO: from_chars no acepta '+' inicial, el resto de formatos de printf sí
+inline bool leerNumero(const char*& p, const char* fin, double& v) {
+    if (p < fin && *p == '+') ++p;
+    std::from_chars_result r = std::from_chars(p, fin, v);
+    if (r.ec != std::errc()) return false;
+    p = r.ptr;
+    return true;
+}
+
+// Parsea una fila. Devuelve cuántos campos tiene, o -1 si alguno no es un número.
+// Deja p al principio de la línea siguiente.
+long parsearFila(const char*& p, const char* fin, double* valores, size_t max) {
+    size_t k = 0;
+    for (;;) {
+        while (p < fin && esEspacio(*p)) ++p;
+        if (p >= fin || *p == '\n' || *p == '#') break;
+        double v;
+        if (!leerNumero(p, fin, v)) {
+            saltarLinea(p, fin);
+            return -1;
+        }
+        if (k < max) valores[k] = v;
+        ++k;
+        while (p < fin && esEspacio(*p)) ++p;
+        if (p < fin && esSeparador(*p)) ++p;
+    }
+    if (p < fin) saltarLinea(p, fin);
+    return long(k);
+}
+
+uint8_t campoPorNombre(std::string nombre) {
+    for (char& c : nombre) c = char(std::tolower(static_cast<unsigned char>(c)));
+    if (nombre == "x") return CAMPO_X;
+    if (nombre == "y") return CAMPO_Y;
+    if (nombre == "z") return CAMPO_Z;
+    if (nombre == "vx") return CAMPO_VX;
+    if (nombre == "vy") return CAMPO_VY;
+    if (nombre == "vz") return CAMPO_VZ;
+    if (nombre == "radio" || nombre == "radius") return CAMPO_RADIO;
+    if (nombre == "masa" || nombre == "mass") return CAMPO_MASA;
+    if (nombre == "r") return CAMPO_R;
+    if (nombre == "g") return CAMPO_G;
+    if (nombre == "b") return CAMPO_B;
+    if (nombre == "prueba") return CAMPO_PRUEBA;
+    return CAMPO_IGNORADO;
+}
+
+void valoresPorDefecto(double* fila) {
+    std::fill(fila, fila + NUM_CAMPOS, 0.0);
+    fila[CAMPO_RADIO] = RADIO_POR_DEFECTO;
+    fila[CAMPO_R] = fila[CAMPO_G] = fila[CAMPO_B] = 1.0;
+}
+
+template <typename T>
+inline void escribirFila(const DestinoEscenario<T>& d, size_t i, const double* fila) {
+    for (int c = 0; c <= CAMPO_MASA; ++c) d.campo[c][i] = T(fila[c]);
+    d.color[i] = Color{float(fila[CAMPO_R]), float(fila[CAMPO_G]), float(fila[CAMPO_B])};
+    d.flags[i] = fila[CAMPO_PRUEBA] != 0.0 ? CUERPO_PRUEBA : 0;
+}
+
+struct ErrorBloque {
+    bool hay = false;
+    size_t linea = 0;
+    std::string mensaje;
+};
+
+} // namespace
+
+bool ArchivoEscenario::abrir(const std::string& ruta_, unsigned hilos_) {
+    cerrar();
+    ruta = ruta_;
+    hilos = hilos_ ? hilos_ : 1;
+
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error al abrir el escenario " << ruta << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "Escenario " << ruta << ": vacío o ilegible\n";
+        close(fd);
+        return false;
+    }
+    bytes = size_t(st.st_size);
+    void* mem = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        std::cerr << "Error al mapear el escenario " << ruta << "\n";
+        bytes = 0;
+        return false;
+    }
+    base = static_cast<const char*>(mem);
+    madvise(mem, bytes, MADV_WILLNEED);
+
+    bool ok;
+    if (bytes >= 8 && std::memcmp(base, MAGIA_SNAPSHOT, 8) == 0) {
+        fmt = FormatoEscenario::SNAPSHOT;
+        ok = true;
+    } else if (bytes >= 8 && std::memcmp(base, MAGIA_ESCENARIO, 8) == 0) {
+        fmt = FormatoEscenario::BINARIO;
+        ok = analizarBinario();
+    } else {
+        fmt = FormatoEscenario::CSV;
+        ok = analizarCsv();
+    }
+    if (!ok) cerrar();
+    return ok;
+}
+
+void ArchivoEscenario::cerrar() {
+    if (base) munmap(const_cast<char*>(base), bytes);
+    base = nullptr;
+    bytes = 0;
+    filas = 0;
+    numColumnas = 0;
+    cortes.clear();
+    filasAntes.clear();
+    lineasAntes.clear();
+}
+
+bool ArchivoEscenario::analizarBinario() {
+    if (bytes < sizeof(CabeceraEscenario)) {
+        std::cerr << "Escenario " << ruta << ": cabecera incompleta\n";
+        return false;
+    }
+    std::memcpy(&cabecera, base, sizeof(cabecera));
+    if (cabecera.version > VERSION_ESCENARIO) {
+        std::cerr << "Escenario " << ruta << ": versión " << cabecera.version << " no soportada\n";
+        return false;
+    }
+    if (cabecera.numColumnas != 8 && cabecera.numColumnas != 11 && cabecera.numColumnas != 12) {
+        std::cerr << "Escenario " << ruta << ": se esperaban 8, 11 o 12 columnas y hay " << cabecera.numColumnas << "\n";
+        return false;
+    }
+    const TipoColumna tipo = static_cast<TipoColumna>(cabecera.tipo);
+    if (tipo != TipoColumna::F32 && tipo != TipoColumna::F64) {
+        std::cerr << "Escenario " << ruta << ": tipo de escalar no soportado\n";
+        return false;
+    }
+    const uint64_t bytesFila = uint64_t(cabecera.numColumnas) * (tipo == TipoColumna::F32 ? 4 : 8);
+    if (cabecera.numCuerpos > (bytes - sizeof(cabecera)) / bytesFila) {
+        std::cerr << "Escenario " << ruta << ": archivo truncado\n";
+        return false;
+    }
+    filas = size_t(cabecera.numCuerpos);
+    numColumnas = cabecera.numColumnas;
+    for (size_t c = 0; c < numColumnas; ++c) campos[c] = uint8_t(c);
+    return true;
+}
+
+bool ArchivoEscenario::analizarCsv() {
+    const char* fin = base + bytes;
+    const char* p = base;
+    if (bytes >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+
+    // Primera línea útil: cabecera o primera fila de datos
+    size_t linea = 1;
+    while (p < fin && !esLineaDatos(p, fin)) {
+        saltarLinea(p, fin);
+        ++linea;
+    }
+    if (p >= fin) {
+        std::cerr << "Escenario " << ruta << ": no contiene cuerpos\n";
+        return false;
+    }
+
+    const char* q = p;
+    while (q < fin && esEspacio(*q)) ++q;
+    double v;
+    const bool conCabecera = !leerNumero(q, fin, v);
+    if (conCabecera) {
+        numColumnas = 0;
+        while (p < fin && *p != '\n' && *p != '#') {
+            while (p < fin && (esEspacio(*p) || esSeparador(*p))) ++p;
+            const char* inicio = p;
+            while (p < fin && !esEspacio(*p) && !esSeparador(*p) && *p != '\n' && *p != '#') ++p;
+            if (p == inicio) continue;
+            if (numColumnas == MAX_COLUMNAS) {
+                std::cerr << "Escenario " << ruta << ": más de " << MAX_COLUMNAS << " columnas\n";
+                return false;
+            }
+            campos[numColumnas++] = campoPorNombre(std::string(inicio, p));
+        }
+        if (p < fin) saltarLinea(p, fin);
+        ++linea;
+
+        bool presente[NUM_CAMPOS] = {};
+        for (size_t c = 0; c < numColumnas; ++c)
+            if (campos[c] != CAMPO_IGNORADO) presente[campos[c]] = true;
+        if (!presente[CAMPO_X] || !presente[CAMPO_Y] || !presente[CAMPO_Z] || !presente[CAMPO_MASA]) {
+            std::cerr << "Escenario " << ruta << ": la cabecera debe incluir x, y, z y masa\n";
+            return false;
+        }
+    } else {
+        // Sin cabecera: el número de campos de la primera fila fija el orden
+        const char* r = p;
+        double valores[MAX_COLUMNAS];
+        long k = parsearFila(r, fin, valores, MAX_COLUMNAS);
+        if (k != 8 && k != 11 && k != 12) {
+            std::cerr << "Escenario " << ruta << ": línea " << linea << ": se esperaban 8, 11 o 12 columnas\n";
+            return false;
+        }
+        numColumnas = size_t(k);
+        for (size_t c = 0; c < numColumnas; ++c) campos[c] = uint8_t(c);
+    }
+    lineaDatos = linea;
+
+    // Bloques que empiezan siempre al principio de una línea
+    const size_t inicio = size_t(p - base);
+    const size_t total = bytes - inicio;
+    const unsigned bloques = unsigned(std::max<size_t>(1, std::min<size_t>(hilos, total / 4096 + 1)));
+    cortes.assign(bloques + 1, bytes);
+    cortes[0] = inicio;
+    for (unsigned b = 1; b < bloques; ++b) {
+        const char* c = base + std::max(inicio + total * b / bloques, cortes[b - 1]);
+        if (c > base + inicio && c < fin && c[-1] != '\n') saltarLinea(c, fin);
+        cortes[b] = size_t(c - base);
+    }
+
+    // Primera pasada: filas de datos y líneas de cada bloque
+    std::vector<size_t> filasBloque(bloques), lineasBloque(bloques);
+    paraleloEnBloques(bloques, bloques, [&](size_t b0, size_t b1, unsigned) {
+        for (size_t b = b0; b < b1; ++b) {
+            const char* r = base + cortes[b];
+            const char* finBloque = base + cortes[b + 1];
+            size_t nFilas = 0, nLineas = 0;
+            while (r < finBloque) {
+                if (esLineaDatos(r, finBloque)) ++nFilas;
+                saltarLinea(r, finBloque);
+                ++nLineas;
+            }
+            filasBloque[b] = nFilas;
+            lineasBloque[b] = nLineas;
+        }
+    });
+
+    filasAntes.assign(bloques, 0);
+    lineasAntes.assign(bloques, 0);
+    filas = 0;
+    size_t lineas = 0;
+    for (unsigned b = 0; b < bloques; ++b) {
+        filasAntes[b] = filas;
+        lineasAntes[b] = lineas;
+        filas += filasBloque[b];
+        lineas += lineasBloque[b];
+    }
+    if (filas == 0) {
+        std::cerr << "Escenario " << ruta << ": no contiene cuerpos\n";
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool ArchivoEscenario::rellenar(const DestinoEscenario<T>& destino) const {
+    if (!base || fmt == FormatoEscenario::SNAPSHOT) return false;
+
+    if (fmt == FormatoEscenario::BINARIO) {
+        const bool f32 = static_cast<TipoColumna>(cabecera.tipo) == TipoColumna::F32;
+        const size_t bytesFila = numColumnas * (f32 ? 4 : 8);
+        const char* datos = base + sizeof(CabeceraEscenario);
+        paraleloEnBloques(filas, hilos, [&](size_t inicio, size_t fin, unsigned) {
+            double fila[NUM_CAMPOS];
+            for (size_t i = inicio; i < fin; ++i) {
+                valoresPorDefecto(fila);
+                const char* src = datos + i * bytesFila;
+                for (size_t c = 0; c < numColumnas; ++c) {
+                    if (f32) {
+                        float v;
+                        std::memcpy(&v, src + c * 4, 4);
+                        fila[c] = v;
+                    } else {
+                        std::memcpy(&fila[c], src + c * 8, 8);
+                    }
+                }
+                escribirFila(destino, i, fila);
+            }
+        });
+        return true;
+    }
+
+    // CSV: cada bloque sabe en qué fila y línea empieza gracias a la primera pasada
+    const unsigned bloques = unsigned(cortes.size() - 1);
+    std::vector<ErrorBloque> errores(bloques);
+    paraleloEnBloques(bloques, bloques, [&](size_t b0, size_t b1, unsigned) {
+        double valores[MAX_COLUMNAS];
+        double fila[NUM_CAMPOS];
+        for (size_t b = b0; b < b1; ++b) {
+            const char* p = base + cortes[b];
+            const char* fin = base + cortes[b + 1];
+            size_t i = filasAntes[b];
+            size_t linea = lineaDatos + lineasAntes[b];
+            for (; p < fin; ++linea) {
+                if (!esLineaDatos(p, fin)) {
+                    saltarLinea(p, fin);
+                    continue;
+                }
+                long k = parsearFila(p, fin, valores, MAX_COLUMNAS);
+                if (k != long(numColumnas)) {
+                    errores[b].hay = true;
+                    errores[b].linea = linea;
+                    errores[b].mensaje = k < 0 ? "valor no numérico"
+                        : "se esperaban " + std::to_string(numColumnas) + " columnas y hay " + std::to_string(k);
+                    return;
+                }
+                valoresPorDefecto(fila);
+                for (size_t c = 0; c < numColumnas; ++c)
+                    if (campos[c] != CAMPO_IGNORADO) fila[campos[c]] = valores[c];
+                escribirFila(destino, i++, fila);
+            }
+        }
+    });
+
+    for (const ErrorBloque& e : errores) {
+        if (!e.hay) continue;
+        std::cerr << "Error al leer el escenario " << ruta << ": línea " << e.linea << ": " << e.mensaje << "\n";
+        return false;
+    }
+    return true;
+}
+
+template bool ArchivoEscenario::rellenar<float>(const DestinoEscenario<float>&) const;
+template bool ArchivoEscenario::rellenar<double>(const DestinoEscenario<double>&) const;
+template bool ArchivoEscenario::rellenar<long double>(const DestinoEscenario<long double>&) const;
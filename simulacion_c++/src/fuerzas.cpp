@@ -0,0 +1,20 @@
+#include <gravedad/integradores.hpp>
+
+// INSTANCIACIONES EXPLÍCITAS DEL MOTOR
+// El resto de unidades las ven como extern y no las vuelven a compilar.
+#define GRAVEDAD_INSTANCIAR_S(P, S) \
+    template void calcularAceleraciones<P, S<typename P::Calculo>>(const Particulas<P>&, typename P::Calculo, const S<typename P::Calculo>&, Aceleraciones<P>&); \
+    template void gravedadMutua<P, S<typename P::Calculo>>(Particulas<P>&, typename P::Calculo, const S<typename P::Calculo>&, typename P::Almacen, Aceleraciones<P>&); \
+    template void gravedadVerlet<P, S<typename P::Calculo>>(Particulas<P>&, typename P::Calculo, const S<typename P::Calculo>&, typename P::Almacen, Aceleraciones<P>&);
+
+#define GRAVEDAD_INSTANCIAR(P) \
+    GRAVEDAD_INSTANCIAR_S(P, SuavizadoCorte) \
+    GRAVEDAD_INSTANCIAR_S(P, SuavizadoPlummer) \
+    GRAVEDAD_INSTANCIAR_S(P, SuavizadoSpline) \
+    template void Collision<P>(Particulas<P>&, size_t, size_t); \
+    template void actualizarPosiciones<P>(Particulas<P>&, typename P::Almacen);
+
+GRAVEDAD_INSTANCIAR(PrecisionSimple)
+GRAVEDAD_INSTANCIAR(PrecisionDoble)
+GRAVEDAD_INSTANCIAR(PrecisionExtendida)
+GRAVEDAD_INSTANCIAR(PrecisionMixta)
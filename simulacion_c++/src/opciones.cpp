@@ -0,0 +1,134 @@
+#include <gravedad/opciones.hpp>
+#include <gravedad/perfilador.hpp>
+
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// El patrón de --capturas va a snprintf con el número de frame como int: exactamente una
+// conversión %d o %i (con banderas y ancho, sin modificadores de longitud); %% vale.
+bool patronConUnEntero(const std::string& patron) {
+    int conversiones = 0;
+    for (size_t i = 0; i < patron.size(); ++i) {
+        if (patron[i] != '%') continue;
+        if (++i < patron.size() && patron[i] == '%') continue;
+        while (i < patron.size() && std::strchr("-+ 0#", patron[i])) ++i;
+        while (i < patron.size() && std::isdigit(static_cast<unsigned char>(patron[i]))) ++i;
+        if (i >= patron.size() || (patron[i] != 'd' && patron[i] != 'i')) return false;
+        conversiones++;
+    }
+    return conversiones == 1;
+}
+
+} // namespace
+
+bool leerOpciones(int argc, char** argv, Opciones& op) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Falta el valor de " << arg << "\n";
+            return false;
+        }
+        std::string valor = argv[++i];
+
+        try {
+            if (arg == "--escenario") op.rutaEscenario = valor;
+            else if (arg == "--generar") op.generador = valor;
+            else if (arg == "--cuerpos") op.cuerposGenerados = std::stoull(valor);
+            else if (arg == "--semilla") op.semilla = std::stoull(valor);
+            else if (arg == "--hilos") op.hilos = unsigned(std::stoul(valor));
+            else if (arg == "--cargar") op.rutaCargar = valor;
+            else if (arg == "--guardar") op.rutaGuardar = valor;
+            else if (arg == "--checkpoint") op.rutaCheckpoint = valor;
+            else if (arg == "--checkpoint-cada") op.pasosCheckpoint = std::stoull(valor);
+            else if (arg == "--trayectoria") op.rutaTrayectoria = valor;
+            else if (arg == "--trayectoria-cada") op.pasosTrayectoria = std::stoull(valor);
+            else if (arg == "--trayectoria-error") op.trayectoria.errorMax = std::stod(valor);
+            else if (arg == "--paso") op.dtFijo = std::stod(valor);
+            else if (arg == "--subpasos-max") op.maxSubpasos = unsigned(std::stoul(valor));
+            else if (arg == "--reproducir") op.rutaReproducir = valor;
+            else if (arg == "--reproducir-fps") op.framesPorSegundo = std::stod(valor);
+            else if (arg == "--diagnosticos") op.rutaDiagnosticos = valor;
+            else if (arg == "--diagnosticos-cada") op.pasosDiagnosticos = std::stoull(valor);
+            else if (arg == "--traza") op.rutaTraza = valor;
+            else if (arg == "--traza-eventos") op.eventosTraza = std::stoull(valor);
+            else if (arg == "--contadores") op.rutaContadores = valor;
+            else if (arg == "--contadores-cada") op.pasosContadores = std::stoull(valor);
+            else if (arg == "--estelas") op.longitudEstelas = std::stoull(valor);
+            else if (arg == "--recorte-px") op.radioMinPx = std::stof(valor);
+            else if (arg == "--frames") op.maxFrames = std::stoull(valor);
+            else if (arg == "--capturas") op.rutaCapturas = valor;
+            else if (arg == "--video") op.rutaVideo = valor;
+            else if (arg == "--video-fps") op.fpsCaptura = std::stod(valor);
+            else if (arg == "--sin-ventana") {
+                const size_t x = valor.find('x');
+                if (x == std::string::npos) throw std::invalid_argument(valor);
+                op.anchoSinVentana = std::stoi(valor.substr(0, x));
+                op.altoSinVentana = std::stoi(valor.substr(x + 1));
+                if (op.anchoSinVentana <= 0 || op.altoSinVentana <= 0) throw std::invalid_argument(valor);
+            } else if (arg == "--trayectoria-codec") {
+                if (valor == "crudo") op.trayectoria.codec = CodecTrayectoria::CRUDO;
+                else if (valor == "cuantizado") op.trayectoria.codec = CodecTrayectoria::CUANTIZADO;
+                else if (valor == "xor") op.trayectoria.codec = CodecTrayectoria::XOR;
+                else {
+                    std::cerr << "Codec de trayectoria desconocido: " << valor << "\n";
+                    return false;
+                }
+            } else if (arg == "--esferas") {
+                if (valor == "malla") op.esferas = ModoEsferas::MALLA;
+                else if (valor == "impostores") op.esferas = ModoEsferas::IMPOSTORES;
+                else {
+                    std::cerr << "Modo de esferas desconocido: " << valor << "\n";
+                    return false;
+                }
+            } else {
+                std::cerr << "Opción desconocida: " << arg << "\n";
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Valor no válido para " << arg << ": " << valor << "\n";
+            return false;
+        }
+    }
+
+    if (op.hilos == 0) op.hilos = 1;
+    if (op.pasosCheckpoint == 0) op.pasosCheckpoint = 1;
+    if (op.pasosTrayectoria == 0) op.pasosTrayectoria = 1;
+    if (op.pasosDiagnosticos == 0) op.pasosDiagnosticos = 1;
+    if (op.eventosTraza == 0) op.eventosTraza = 1;
+    if (op.pasosContadores == 0) op.pasosContadores = 1;
+    if (op.longitudEstelas == 1) op.longitudEstelas = 2; // una línea necesita dos puntos
+    if (op.radioMinPx < 0.0f) op.radioMinPx = 0.0f;
+    if (!(op.dtFijo > 0.0)) {
+        std::cerr << "--paso debe ser positivo\n";
+        return false;
+    }
+    if (!(op.trayectoria.errorMax > 0.0) || !std::isfinite(op.trayectoria.errorMax)) {
+        std::cerr << "--trayectoria-error debe ser positivo\n";
+        return false;
+    }
+    if (op.maxSubpasos == 0) op.maxSubpasos = 1;
+    if (op.fpsCaptura <= 0.0) op.fpsCaptura = 60.0;
+    if (!op.rutaCapturas.empty() && !patronConUnEntero(op.rutaCapturas)) {
+        std::cerr << "--capturas necesita un patrón con un solo %d para el número de frame (p. ej. f%05d.png): "
+                  << op.rutaCapturas << "\n";
+        return false;
+    }
+    if (!op.rutaCapturas.empty() && !op.rutaVideo.empty()) {
+        std::cerr << "--capturas y --video no se pueden usar a la vez\n";
+        return false;
+    }
+    if (op.anchoSinVentana > 0 && op.maxFrames == 0) {
+        std::cerr << "--sin-ventana necesita --frames\n";
+        return false;
+    }
+    if (!op.rutaTraza.empty() && !PERFILADOR_ACTIVO)
+        std::cerr << "Aviso: --traza no tiene efecto, compila con -DGRAVEDAD_PERFILADOR=ON\n";
+    if (!op.rutaContadores.empty() && !PERFILADOR_ACTIVO)
+        std::cerr << "Aviso: --contadores no tiene efecto, compila con -DGRAVEDAD_PERFILADOR=ON\n";
+    return true;
+}
@@ -0,0 +1,175 @@
+#include <gravedad/perfilador.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// BUFFER CIRCULAR DE UN HILO
+// Solo escribe su hilo; 'escritos' con release para que la exportación vea eventos completos.
+struct BufferHilo {
+    uint32_t tid = 0;
+    std::string nombre;
+    std::vector<EventoZona> eventos;
+    std::atomic<uint64_t> escritos{0};
+};
+
+// Los hilos de vida corta (los de paraleloEnBloques) reutilizan el buffer de uno que
+// ya terminó, así el número de buffers no crece con cada paso.
+struct Registro {
+    std::mutex m;
+    std::vector<std::unique_ptr<BufferHilo>> buffers;
+    std::vector<BufferHilo*> libres;
+    size_t eventosPorHilo = size_t(1) << 16;
+};
+
+// Nunca se destruye: los hilos pueden devolver su buffer durante la salida
+Registro& registro() {
+    static Registro* r = new Registro;
+    return *r;
+}
+
+struct DuenoBuffer {
+    BufferHilo* b = nullptr;
+    ~DuenoBuffer() {
+        if (!b) return;
+        Registro& r = registro();
+        std::lock_guard<std::mutex> lock(r.m);
+        r.libres.push_back(b);
+    }
+};
+
+thread_local DuenoBuffer dueno;
+
+BufferHilo* bufferDelHilo() {
+    if (dueno.b) return dueno.b;
+    Registro& r = registro();
+    std::lock_guard<std::mutex> lock(r.m);
+    if (!r.libres.empty()) {
+        dueno.b = r.libres.back();
+        r.libres.pop_back();
+    } else {
+        r.buffers.emplace_back(new BufferHilo);
+        dueno.b = r.buffers.back().get();
+        dueno.b->tid = uint32_t(r.buffers.size());
+        dueno.b->eventos.resize(r.eventosPorHilo);
+    }
+    return dueno.b;
+}
+
+// Recorre los eventos que siguen en el buffer, del más antiguo al más reciente
+template <typename F>
+void paraCadaEvento(const BufferHilo& b, F f) {
+    const uint64_t n = b.escritos.load(std::memory_order_acquire);
+    const uint64_t cap = b.eventos.size();
+    for (uint64_t k = n > cap ? n - cap : 0; k < n; ++k) f(b.eventos[k % cap]);
+}
+
+void escribirCadena(FILE* f, const char* s) {
+    std::fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') std::fputc('\\', f);
+        std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+} // namespace
+
+uint64_t relojPerfilador() {
+    static const auto origen = std::chrono::steady_clock::now();
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origen).count());
+}
+
+void registrarZona(const char* nombre, uint64_t inicioNs, uint64_t finNs) {
+    BufferHilo* b = bufferDelHilo();
+    const uint64_t n = b->escritos.load(std::memory_order_relaxed);
+    b->eventos[n % b->eventos.size()] = EventoZona{nombre, inicioNs, finNs - inicioNs};
+    b->escritos.store(n + 1, std::memory_order_release);
+}
+
+void nombrarHiloPerfilador(const char* nombre) {
+    BufferHilo* b = bufferDelHilo();
+    std::lock_guard<std::mutex> lock(registro().m);
+    b->nombre = nombre;
+}
+
+void configurarPerfilador(size_t eventosPorHilo) {
+    std::lock_guard<std::mutex> lock(registro().m);
+    registro().eventosPorHilo = std::max<size_t>(eventosPorHilo, 1);
+}
+
+bool exportarTrazaChrome(const std::string& ruta) {
+    FILE* f = std::fopen(ruta.c_str(), "w");
+    if (!f) {
+        std::cerr << "Error al crear la traza " << ruta << "\n";
+        return false;
+    }
+
+    Registro& r = registro();
+    std::lock_guard<std::mutex> lock(r.m);
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    bool primero = true;
+    for (const auto& b : r.buffers) {
+        std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                     primero ? "" : ",\n", b->tid);
+        if (b->nombre.empty()) std::fprintf(f, "\"hilo %u\"", b->tid);
+        else escribirCadena(f, b->nombre.c_str());
+        std::fputs("}}", f);
+        primero = false;
+
+        // ts y dur en microsegundos
+        paraCadaEvento(*b, [&](const EventoZona& e) {
+            std::fputs(",\n{\"name\":", f);
+            escribirCadena(f, e.nombre);
+            std::fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", b->tid,
+                         double(e.inicioNs) * 1e-3, double(e.duracionNs) * 1e-3);
+        });
+    }
+    std::fputs("\n]}\n", f);
+
+    bool ok = !std::ferror(f);
+    if (std::fclose(f) != 0) ok = false;
+    if (!ok) std::cerr << "Error al escribir la traza " << ruta << "\n";
+    return ok;
+}
+
+void imprimirResumenPerfilador() {
+    struct Total {
+        uint64_t llamadas = 0;
+        uint64_t ns = 0;
+    };
+    std::map<std::string, Total> zonas;
+    uint64_t perdidos = 0;
+
+    Registro& r = registro();
+    {
+        std::lock_guard<std::mutex> lock(r.m);
+        for (const auto& b : r.buffers) {
+            const uint64_t n = b->escritos.load(std::memory_order_acquire);
+            if (n > b->eventos.size()) perdidos += n - b->eventos.size();
+            paraCadaEvento(*b, [&](const EventoZona& e) {
+                Total& t = zonas[e.nombre];
+                t.llamadas++;
+                t.ns += e.duracionNs;
+            });
+        }
+    }
+
+    std::vector<std::pair<std::string, Total>> orden(zonas.begin(), zonas.end());
+    std::sort(orden.begin(), orden.end(), [](const auto& a, const auto& b) { return a.second.ns > b.second.ns; });
+    std::printf("%-24s %10s %12s %12s\n", "zona", "llamadas", "total ms", "media us");
+    for (const auto& z : orden)
+        std::printf("%-24s %10llu %12.3f %12.3f\n", z.first.c_str(), (unsigned long long)z.second.llamadas,
+                    double(z.second.ns) * 1e-6, double(z.second.ns) * 1e-3 / double(z.second.llamadas));
+    if (perdidos > 0)
+        std::printf("(%llu eventos antiguos pisados: el resumen cubre solo los más recientes)\n",
+                    (unsigned long long)perdidos);
+}
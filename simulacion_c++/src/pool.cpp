@@ -0,0 +1,106 @@
+#include <gravedad/pool.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+IdCuerpo MapaIds::insertar() {
+    uint32_t r;
+    if (primeraLibre != NINGUNA) {
+        r = primeraLibre;
+        primeraLibre = ranuras[r].denso;
+    } else {
+        r = static_cast<uint32_t>(ranuras.size());
+        ranuras.push_back(Ranura());
+    }
+
+    ranuras[r].denso = static_cast<uint32_t>(densoARanura.size());
+    densoARanura.push_back(r);
+    return IdCuerpo{r, ranuras[r].generacion};
+}
+
+size_t MapaIds::eliminar(IdCuerpo id) {
+    assert(contiene(id));
+    uint32_t hueco = ranuras[id.indice].denso;
+    uint32_t ultimaRanura = densoARanura.back();
+
+    // El último denso pasa al hueco
+    densoARanura[hueco] = ultimaRanura;
+    ranuras[ultimaRanura].denso = hueco;
+    densoARanura.pop_back();
+
+    // La ranura se recicla con otra generación
+    ranuras[id.indice].generacion++;
+    ranuras[id.indice].denso = primeraLibre;
+    primeraLibre = id.indice;
+    return hueco;
+}
+
+bool MapaIds::contiene(IdCuerpo id) const {
+    return id.indice < ranuras.size()
+        && ranuras[id.indice].generacion == id.generacion
+        && ranuras[id.indice].denso < densoARanura.size()
+        && densoARanura[ranuras[id.indice].denso] == id.indice;
+}
+
+IdCuerpo MapaIds::idDe(size_t denso) const {
+    uint32_t r = densoARanura[denso];
+    return IdCuerpo{r, ranuras[r].generacion};
+}
+
+void MapaIds::reservar(size_t n) {
+    ranuras.reserve(n);
+    densoARanura.reserve(n);
+}
+
+void MapaIds::limpiar() {
+    // Las generaciones se conservan para que los ids antiguos sigan siendo inválidos
+    for (uint32_t r = 0; r < ranuras.size(); ++r) {
+        if (ranuras[r].denso < densoARanura.size() && densoARanura[ranuras[r].denso] == r)
+            ranuras[r].generacion++;
+    }
+    densoARanura.clear();
+    primeraLibre = NINGUNA;
+    for (uint32_t r = static_cast<uint32_t>(ranuras.size()); r-- > 0;) {
+        ranuras[r].denso = primeraLibre;
+        primeraLibre = r;
+    }
+}
+
+bool MapaIds::reconstruir(size_t n, const uint32_t* indices, const uint32_t* generaciones) {
+    if (n >= NINGUNA) return false;
+    // Ids de fuera (snapshots, trayectorias): sin NINGUNA, sin repetidos y con un número
+    // de ranuras acotado, antes de reservar nada del tamaño que diga el archivo
+    uint32_t maxRanura = static_cast<uint32_t>(n);
+    if (indices) {
+        std::vector<uint32_t> orden(indices, indices + n);
+        std::sort(orden.begin(), orden.end());
+        if (std::adjacent_find(orden.begin(), orden.end()) != orden.end()) return false;
+        maxRanura = 0;
+        if (!orden.empty()) {
+            if (orden.back() == NINGUNA || orden.back() >= maxRanurasPara(n)) return false;
+            maxRanura = orden.back() + 1;
+        }
+    }
+
+    // Las ranuras conservan su generación (la de antes de recargar, o la del archivo
+    // para las que tienen cuerpo): así los ids antiguos siguen siendo inválidos
+    if (ranuras.size() < maxRanura) ranuras.resize(maxRanura);
+    for (Ranura& r : ranuras) r.denso = NINGUNA;
+    densoARanura.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t r = indices ? indices[i] : static_cast<uint32_t>(i);
+        ranuras[r].denso = static_cast<uint32_t>(i);
+        if (generaciones) ranuras[r].generacion = generaciones[i];
+        densoARanura[i] = r;
+    }
+
+    // Las ranuras sin cuerpo forman la lista libre
+    primeraLibre = NINGUNA;
+    for (uint32_t r = static_cast<uint32_t>(ranuras.size()); r-- > 0;) {
+        if (ranuras[r].denso == NINGUNA) {
+            ranuras[r].denso = primeraLibre;
+            primeraLibre = r;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,125 @@
+#include <render/anillo.hpp>
+
+#include <gravedad/perfilador.hpp>
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// De GL 4.4 (glad no los trae)
+constexpr GLbitfield MAPA_PERSISTENTE = 0x0040; // GL_MAP_PERSISTENT_BIT
+constexpr GLbitfield MAPA_COHERENTE = 0x0080;   // GL_MAP_COHERENT_BIT
+
+bool tieneExtension(const char* nombre) {
+    GLint n = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+    for (GLint i = 0; i < n; ++i) {
+        const char* e = (const char*)glGetStringi(GL_EXTENSIONS, GLuint(i));
+        if (e && std::strcmp(e, nombre) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+bool AnilloInstancias::crear(GLADloadproc cargar, size_t instanciasPorFrame) {
+    const bool gl44 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+    if (cargar && (gl44 || tieneExtension("GL_ARB_buffer_storage")))
+        bufferStorage = (FuncionBufferStorage)cargar("glBufferStorage");
+    return crearAlmacen(instanciasPorFrame);
+}
+
+bool AnilloInstancias::crearAlmacen(size_t instanciasPorFrame) {
+    capacidadTramo = instanciasPorFrame ? instanciasPorFrame : 1;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (!bufferStorage) return vbo != 0; // GL 3.3: el almacén se reserva en cada escribir()
+
+    const GLsizeiptr bytes = GLsizeiptr(NUM_TRAMOS_ANILLO * capacidadTramo * sizeof(InstanciaEsfera));
+    const GLbitfield flags = GL_MAP_WRITE_BIT | MAPA_PERSISTENTE | MAPA_COHERENTE;
+    bufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+    mapa = (InstanciaEsfera*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+    if (!mapa) {
+        std::cerr << "Error al mapear el buffer de instancias, se usa glBufferData\n";
+        glDeleteBuffers(1, &vbo);
+        bufferStorage = nullptr;
+        return crearAlmacen(instanciasPorFrame);
+    }
+    return true;
+}
+
+void AnilloInstancias::esperarTramo(int t) {
+    if (!fences[t]) return;
+    // Sin esperar primero: si ya terminó no cuenta como espera
+    GLenum r = glClientWaitSync(fences[t], 0, 0);
+    if (r == GL_TIMEOUT_EXPIRED) {
+        ZONA("esperar GPU");
+        numEsperas++;
+        do r = glClientWaitSync(fences[t], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms
+        while (r == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fences[t]);
+    fences[t] = 0;
+}
+
+InstanciaEsfera* AnilloInstancias::escribir(size_t n) {
+    if (!mapa) {
+        // GL 3.3: buffer nuevo (el anterior sigue vivo para la GPU) y mapeado sin sincronizar
+        primeraInstancia = 0;
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        const GLsizeiptr bytes = GLsizeiptr((n ? n : 1) * sizeof(InstanciaEsfera));
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        void* p = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        mapeado = p != nullptr;
+        return (InstanciaEsfera*)p;
+    }
+
+    if (n > capacidadTramo) {
+        // No cabe: se espera a que la GPU suelte todo y se rehace con el doble
+        for (int t = 0; t < NUM_TRAMOS_ANILLO; ++t) esperarTramo(t);
+        size_t nueva = capacidadTramo;
+        while (nueva < n) nueva *= 2;
+        destruir();
+        if (!crearAlmacen(nueva)) return nullptr;
+        if (!mapa) return escribir(n);
+    }
+    esperarTramo(tramo);
+    primeraInstancia = size_t(tramo) * capacidadTramo;
+    return mapa + primeraInstancia;
+}
+
+bool AnilloInstancias::publicar() {
+    // Mapeo coherente: lo escrito ya es visible para los comandos que vengan después
+    if (mapa) return true;
+    if (!mapeado) return false;
+    mapeado = false;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE) {
+        std::cerr << "Error al subir las instancias: el driver perdió el buffer mapeado\n";
+        return false;
+    }
+    return true;
+}
+
+void AnilloInstancias::terminarFrame() {
+    if (!mapa) return;
+    fences[tramo] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    tramo = (tramo + 1) % NUM_TRAMOS_ANILLO;
+}
+
+void AnilloInstancias::destruir() {
+    for (GLsync& f : fences) {
+        if (f) glDeleteSync(f);
+        f = 0;
+    }
+    if (vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        if (mapa || mapeado) glUnmapBuffer(GL_ARRAY_BUFFER);
+        glDeleteBuffers(1, &vbo);
+    }
+    vbo = 0;
+    mapa = nullptr;
+    mapeado = false;
+    tramo = 0;
+}
@@ -0,0 +1,33 @@
+#include <render/camara.hpp>
+
+#include <iostream>
+
+bool enlazarBloqueCamara(GLuint programa) {
+    GLuint indice = glGetUniformBlockIndex(programa, "Camara");
+    if (indice == GL_INVALID_INDEX) {
+        std::cerr << "Error al enlazar la cámara: el programa no declara el bloque 'Camara'\n";
+        return false;
+    }
+    glUniformBlockBinding(programa, indice, ENLACE_CAMARA);
+    return true;
+}
+
+bool BufferCamara::crear() {
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(DatosCamara), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, ENLACE_CAMARA, ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return ubo != 0;
+}
+
+void BufferCamara::actualizar(const DatosCamara& datos) {
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(DatosCamara), &datos);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void BufferCamara::destruir() {
+    glDeleteBuffers(1, &ubo);
+    ubo = 0;
+}
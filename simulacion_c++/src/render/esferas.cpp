@@ -0,0 +1,176 @@
+#include <render/camara.hpp>
+#include <render/esferas.hpp>
+#include <render/programa.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char* vertexShaderSource = "#version 330 core\n" GLSL_BLOQUE_CAMARA R"(
+    layout(location = 0) in vec3 aPos;
+    layout(location = 1) in vec3 aNormal;
+    layout(location = 2) in vec4 aPosRadio; // por instancia: centro y radio
+    layout(location = 3) in vec3 aColor;    // por instancia
+
+    out vec3 FragPos;
+    out vec3 Normal;
+    out vec3 ObjectColor;
+
+    void main(){
+        // El modelo es solo traslación + escala uniforme: la matriz normal
+        // (inversa traspuesta) es la identidad salvo un factor, que se quita al
+        // normalizar en el fragment shader. No hace falta invertir nada por vértice.
+        FragPos = aPosRadio.xyz + aPosRadio.w * aPos;
+        Normal = aNormal;
+        ObjectColor = aColor;
+        gl_Position = projection * view * vec4(FragPos,1.0);
+    }
+)";
+
+const char* fragmentShaderSource = "#version 330 core\n" GLSL_BLOQUE_CAMARA R"(
+    out vec4 FragColor;
+
+    in vec3 FragPos;
+    in vec3 Normal;
+    in vec3 ObjectColor;
+
+    void main(){
+        // Ambient
+        float ambientStrength = 0.2;
+        vec3 ambient = ambientStrength * lightColor.rgb;
+
+        // Diffuse
+        vec3 norm = normalize(Normal);
+        vec3 lightDir = normalize(lightPos.xyz - FragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor.rgb;
+
+        // Specular
+        float specularStrength = 0.5;
+        vec3 viewDir = normalize(viewPos.xyz - FragPos);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+        vec3 specular = specularStrength * spec * lightColor.rgb;
+
+        vec3 result = (ambient + diffuse + specular) * ObjectColor;
+        FragColor = vec4(result, 1.0);
+    }
+)";
+
+} // namespace
+
+void apuntarInstancias(size_t primera) {
+    const size_t base = primera * sizeof(InstanciaEsfera);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(InstanciaEsfera), (void*)(base + offsetof(InstanciaEsfera, x)));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(InstanciaEsfera), (void*)(base + offsetof(InstanciaEsfera, r)));
+}
+
+void crearEsfera(std::vector<float>& vertices, std::vector<unsigned int>& indices, int sectorCount, int stackCount) {
+    float radius = 1.0f;
+    for (int i = 0; i <= stackCount; i++) {
+        float stackAngle = M_PI / 2 - i * M_PI / stackCount;
+        float xy = radius * cosf(stackAngle);
+        float z = radius * sinf(stackAngle);
+
+        for (int j = 0; j <= sectorCount; j++) {
+            float sectorAngle = j * 2 * M_PI / sectorCount;
+            float x = xy * cosf(sectorAngle);
+            float y = xy * sinf(sectorAngle);
+            vertices.push_back(x);
+            vertices.push_back(y);
+            vertices.push_back(z);
+
+            // En la esfera unidad la normal es la propia posición
+            vertices.push_back(x / radius);
+            vertices.push_back(y / radius);
+            vertices.push_back(z / radius);
+        }
+    }
+    for (int i = 0; i < stackCount; ++i) {
+        for (int j = 0; j < sectorCount; ++j) {
+            int k1 = i * (sectorCount + 1) + j;
+            int k2 = k1 + sectorCount + 1;
+
+            // 2 triangulos por sector
+            indices.push_back(k1);
+            indices.push_back(k2);
+            indices.push_back(k1 + 1);
+
+            indices.push_back(k1 + 1);
+            indices.push_back(k2);
+            indices.push_back(k2 + 1);
+        }
+    }
+}
+
+bool RenderEsferas::iniciar(int sectores, int pilas) {
+    programa = crearPrograma(vertexShaderSource, fragmentShaderSource);
+    if (!programa || !enlazarBloqueCamara(programa)) return false;
+
+    // Todos los niveles en el mismo VBO/EBO, cada uno con sus índices relativos
+    std::vector<float> sphereVertices;
+    std::vector<unsigned int> sphereIndices;
+    for (int k = 0; k < NIVELES_LOD; ++k) {
+        Malla& m = mallas[k];
+        m.sectores = std::max(sectores >> k, 6);
+        m.primerIndice = sphereIndices.size();
+        m.primerVertice = GLint(sphereVertices.size() / 6);
+        crearEsfera(sphereVertices, sphereIndices, m.sectores, std::max(pilas >> k, 3));
+        m.numIndices = GLsizei(sphereIndices.size() - m.primerIndice);
+    }
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sphereVertices.size() * sizeof(float), sphereVertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices.size() * sizeof(unsigned int), sphereIndices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // Atributos por instancia (avanzan una vez por esfera, no por vértice); el buffer
+    // se engancha en cada dibujar()
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    glBindVertexArray(0);
+    return true;
+}
+
+void RenderEsferas::limitesLod(float radioMaxNivel[NIVELES_LOD]) const {
+    // El nivel k sirve mientras la arista 2*pi*R/sectores quede bajo PIXELES_ARISTA_LOD
+    for (int k = 0; k < NIVELES_LOD; ++k)
+        radioMaxNivel[k] = mallas[k].sectores * PIXELES_ARISTA_LOD / float(2.0 * M_PI);
+}
+
+void RenderEsferas::dibujar(GLuint buffer, size_t primera, const size_t cuentaNivel[NIVELES_LOD]) {
+    glUseProgram(programa);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (int k = 0; k < NIVELES_LOD; ++k) {
+        if (cuentaNivel[k] == 0) continue;
+        const Malla& m = mallas[k];
+        apuntarInstancias(primera);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m.numIndices, GL_UNSIGNED_INT,
+                                          (void*)(m.primerIndice * sizeof(unsigned int)),
+                                          GLsizei(cuentaNivel[k]), m.primerVertice);
+        primera += cuentaNivel[k];
+    }
+    glBindVertexArray(0);
+}
+
+void RenderEsferas::destruir() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteProgram(programa);
+    vao = vbo = ebo = programa = 0;
+}
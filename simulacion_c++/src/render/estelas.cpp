@@ -0,0 +1,138 @@
+#include <render/camara.hpp>
+#include <render/estelas.hpp>
+#include <render/programa.hpp>
+
+#include <iostream>
+
+namespace {
+
+// Vértice 'edad' de la instancia i = posición del cuerpo i hace 'edad' frames
+const char* vertexShaderSource = "#version 330 core\n" GLSL_BLOQUE_CAMARA R"(
+    layout(location = 3) in vec3 aColor; // por instancia
+
+    uniform samplerBuffer muestras;
+    uniform int cuerpos;
+    uniform int longitud;
+    uniform int cabeza;
+    uniform int numMuestras;
+
+    out vec4 Color;
+
+    void main(){
+        int edad = gl_VertexID;
+        int ranura = (cabeza - edad + longitud) % longitud;
+        vec3 p = texelFetch(muestras, ranura * cuerpos + gl_InstanceID).xyz;
+        Color = vec4(aColor, 0.8 * (1.0 - float(edad) / float(numMuestras)));
+        gl_Position = projection * view * vec4(p, 1.0);
+    }
+)";
+
+const char* fragmentShaderSource = R"(
+    #version 330 core
+    in vec4 Color;
+    out vec4 FragColor;
+
+    void main(){
+        FragColor = Color;
+    }
+)";
+
+} // namespace
+
+bool RenderEstelas::iniciar(size_t longitud_) {
+    longitudPedida = longitud = longitud_;
+    programa = crearPrograma(vertexShaderSource, fragmentShaderSource);
+    if (!programa || !enlazarBloqueCamara(programa)) return false;
+
+    // Las ubicaciones se buscan una vez
+    glUseProgram(programa);
+    glUniform1i(glGetUniformLocation(programa, "muestras"), 0);
+    locCuerpos = glGetUniformLocation(programa, "cuerpos");
+    locLongitud = glGetUniformLocation(programa, "longitud");
+    locCabeza = glGetUniformLocation(programa, "cabeza");
+    locNumMuestras = glGetUniformLocation(programa, "numMuestras");
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vboColores);
+    glGenBuffers(1, &bufferMuestras);
+    glGenTextures(1, &texturaMuestras);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vboColores);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glBindVertexArray(0);
+    return true;
+}
+
+void RenderEstelas::subirMuestra(size_t n) {
+    if (n != cuerpos) {
+        // Empezar de nuevo con el anillo a la medida, desde la longitud pedida
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        longitud = longitudPedida;
+        if (n > 0 && n * longitud > size_t(maxTexels)) {
+            const size_t caben = size_t(maxTexels) / n;
+            if (caben < 2) {
+                std::cerr << "Aviso: las estelas de " << n << " cuerpos no caben en un buffer de textura, "
+                          << "se desactivan\n";
+                longitud = 0;
+            } else {
+                std::cerr << "Aviso: las estelas de " << n << " cuerpos no caben con " << longitud
+                          << " muestras, se usan " << caben << "\n";
+                longitud = caben;
+            }
+        }
+        cuerpos = n;
+        cabeza = 0;
+        numMuestras = 0;
+
+        glBindBuffer(GL_TEXTURE_BUFFER, bufferMuestras);
+        glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(bytes()), NULL, GL_DYNAMIC_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, texturaMuestras);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, bufferMuestras);
+        glBindBuffer(GL_ARRAY_BUFFER, vboColores);
+        glBufferData(GL_ARRAY_BUFFER, colores.size() * sizeof(float), colores.data(), GL_STATIC_DRAW);
+    } else if (longitud > 0) {
+        cabeza = (cabeza + 1) % longitud;
+    }
+    if (n == 0 || longitud == 0) return;
+
+    // Solo la ranura nueva: N posiciones
+    const size_t bytesRanura = n * 4 * sizeof(float);
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferMuestras);
+    glBufferSubData(GL_TEXTURE_BUFFER, GLintptr(cabeza * bytesRanura), GLsizeiptr(bytesRanura), muestra.data());
+    if (numMuestras < longitud) numMuestras++;
+}
+
+void RenderEstelas::dibujar() {
+    if (numMuestras < 2) return;
+
+    glUseProgram(programa);
+    glUniform1i(locCuerpos, GLint(cuerpos));
+    glUniform1i(locLongitud, GLint(longitud));
+    glUniform1i(locCabeza, GLint(cabeza));
+    glUniform1i(locNumMuestras, GLint(numMuestras));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, texturaMuestras);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    glBindVertexArray(vao);
+    glDrawArraysInstanced(GL_LINE_STRIP, 0, GLsizei(numMuestras), GLsizei(cuerpos));
+    glBindVertexArray(0);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+void RenderEstelas::destruir() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vboColores);
+    glDeleteBuffers(1, &bufferMuestras);
+    glDeleteTextures(1, &texturaMuestras);
+    glDeleteProgram(programa);
+    vao = vboColores = bufferMuestras = texturaMuestras = programa = 0;
+    cuerpos = cabeza = numMuestras = 0;
+}
@@ -0,0 +1,263 @@
+#include <render/grabador.hpp>
+
+#include <gravedad/perfilador.hpp>
+
+#include <cstring>
+#include <iostream>
+
+#ifdef GRAVEDAD_CON_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+// CRC de los chunks PNG
+uint32_t crc32Png(const uint8_t* datos, size_t n, uint32_t crc = 0) {
+    static uint32_t tabla[256];
+    static bool hecha = false;
+    if (!hecha) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            tabla[i] = c;
+        }
+        hecha = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = tabla[(crc ^ datos[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void anadirU32(std::vector<uint8_t>& v, uint32_t x) {
+    const uint8_t b[4] = {uint8_t(x >> 24), uint8_t(x >> 16), uint8_t(x >> 8), uint8_t(x)};
+    v.insert(v.end(), b, b + 4);
+}
+
+void anadirChunk(std::vector<uint8_t>& png, const char tipo[4], const uint8_t* datos, size_t n) {
+    anadirU32(png, uint32_t(n));
+    const size_t inicio = png.size();
+    png.insert(png.end(), tipo, tipo + 4);
+    png.insert(png.end(), datos, datos + n);
+    anadirU32(png, crc32Png(png.data() + inicio, n + 4));
+}
+
+// Flujo zlib de 'crudo': con zlib, nivel 1 (rápido); sin él, bloques sin comprimir
+void comprimirZlib(const std::vector<uint8_t>& crudo, std::vector<uint8_t>& salida) {
+#ifdef GRAVEDAD_CON_ZLIB
+    uLongf tam = compressBound(uLong(crudo.size()));
+    salida.resize(tam);
+    compress2(salida.data(), &tam, crudo.data(), uLong(crudo.size()), 1);
+    salida.resize(tam);
+#else
+    salida.clear();
+    salida.push_back(0x78);
+    salida.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < crudo.size(); ++i) {
+        a = (a + crudo[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    for (size_t pos = 0; pos < crudo.size() || pos == 0;) {
+        const size_t n = std::min<size_t>(65535, crudo.size() - pos);
+        const bool ultimo = pos + n == crudo.size();
+        salida.push_back(ultimo ? 1 : 0);
+        salida.push_back(uint8_t(n));
+        salida.push_back(uint8_t(n >> 8));
+        salida.push_back(uint8_t(~n));
+        salida.push_back(uint8_t(~n >> 8));
+        salida.insert(salida.end(), crudo.begin() + pos, crudo.begin() + pos + n);
+        pos += n;
+        if (ultimo) break;
+    }
+    anadirU32(salida, (b << 16) | a);
+#endif
+}
+
+} // namespace
+
+bool GrabadorFrames::abrir(const std::string& destino_, FormatoCaptura formato_, int ancho_, int alto_) {
+    cerrar();
+    destino = destino_;
+    formato = formato_;
+    ancho = ancho_;
+    alto = alto_;
+
+    if (formato == FormatoCaptura::YUV) {
+        if (ancho % 2 || alto % 2) {
+            std::cerr << "Error al abrir el vídeo: yuv420p necesita ancho y alto pares (" << ancho << "x" << alto << ")\n";
+            return false;
+        }
+        esTuberia = !destino.empty() && destino[0] == '|';
+        video = esTuberia ? popen(destino.c_str() + 1, "w") : std::fopen(destino.c_str(), "wb");
+        if (!video) {
+            std::cerr << "Error al abrir el vídeo " << destino << "\n";
+            return false;
+        }
+    }
+
+    const GLsizeiptr bytes = GLsizeiptr(ancho) * alto * 4;
+    glGenBuffers(NUM_PBO_CAPTURA, pbos);
+    for (GLuint pbo : pbos) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    cola.reset(new ColaAcotada<Imagen>(4));
+    libres.reset(new ColaAcotada<std::vector<uint8_t>>(8));
+    numFrames = 0;
+    numEscritos = 0;
+    numEsperas = 0;
+    error = false;
+    hilo = std::thread([this] { bucleEscritura(); });
+    return true;
+}
+
+void GrabadorFrames::capturar(int anchoFb, int altoFb) {
+    if (!cola) return;
+    if (anchoFb != ancho || altoFb != alto) {
+        std::cerr << "Error al capturar: el framebuffer ha pasado de " << ancho << "x" << alto << " a "
+                  << anchoFb << "x" << altoFb << ", se detiene la grabación\n";
+        cerrar();
+        return;
+    }
+    ZONA("captura");
+    // El PBO de hace NUM_PBO_CAPTURA - 1 frames: su copia ya debería haber terminado
+    if (fences[siguiente]) entregar(siguiente);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[siguiente]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, ancho, alto, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences[siguiente] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    numeroPbo[siguiente] = numFrames++;
+    siguiente = (siguiente + 1) % NUM_PBO_CAPTURA;
+}
+
+void GrabadorFrames::entregar(int i) {
+    ZONA("captura leer PBO");
+    while (glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED) {}
+    glDeleteSync(fences[i]);
+    fences[i] = 0;
+
+    Imagen im;
+    im.numero = numeroPbo[i];
+    if (!libres->intentarSacar(im.rgba)) im.rgba.clear();
+    const size_t bytes = size_t(ancho) * alto * 4;
+    im.rgba.resize(bytes);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+    const void* p = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(bytes), GL_MAP_READ_BIT);
+    if (p) {
+        std::memcpy(im.rgba.data(), p, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!p) {
+        std::cerr << "Error al leer el frame " << im.numero << " capturado\n";
+        return;
+    }
+    bool espero = false;
+    cola->meter(std::move(im), &espero);
+    if (espero) numEsperas++;
+}
+
+void GrabadorFrames::bucleEscritura() {
+    NOMBRAR_HILO("capturas E/S");
+    Imagen im;
+    while (cola->sacar(im)) {
+        if (!error && escribirImagen(im)) numEscritos++;
+        libres->intentarMeter(std::move(im.rgba));
+    }
+}
+
+bool GrabadorFrames::escribirImagen(const Imagen& im) {
+    ZONA("captura codificar");
+    const size_t fila = size_t(ancho) * 4;
+    if (formato == FormatoCaptura::PNG) {
+        // Filas de arriba abajo, RGB, filtro 0
+        std::vector<uint8_t> crudo(size_t(alto) * (1 + size_t(ancho) * 3));
+        uint8_t* o = crudo.data();
+        for (int y = alto - 1; y >= 0; --y) {
+            const uint8_t* s = im.rgba.data() + size_t(y) * fila;
+            *o++ = 0;
+            for (int x = 0; x < ancho; ++x, s += 4, o += 3) {
+                o[0] = s[0];
+                o[1] = s[1];
+                o[2] = s[2];
+            }
+        }
+        std::vector<uint8_t> idat;
+        comprimirZlib(crudo, idat);
+
+        codificado.assign({0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'});
+        uint8_t ihdr[13];
+        const uint32_t w = uint32_t(ancho), h = uint32_t(alto);
+        const uint8_t cab[13] = {uint8_t(w >> 24), uint8_t(w >> 16), uint8_t(w >> 8), uint8_t(w),
+                                 uint8_t(h >> 24), uint8_t(h >> 16), uint8_t(h >> 8), uint8_t(h),
+                                 8, 2, 0, 0, 0}; // 8 bits, RGB
+        std::memcpy(ihdr, cab, sizeof(ihdr));
+        anadirChunk(codificado, "IHDR", ihdr, sizeof(ihdr));
+        anadirChunk(codificado, "IDAT", idat.data(), idat.size());
+        anadirChunk(codificado, "IEND", nullptr, 0);
+
+        char ruta[4096];
+        std::snprintf(ruta, sizeof(ruta), destino.c_str(), int(im.numero)); // un solo %d (ver leerOpciones)
+        std::FILE* f = std::fopen(ruta, "wb");
+        bool ok = f && std::fwrite(codificado.data(), 1, codificado.size(), f) == codificado.size();
+        if (f && std::fclose(f) != 0) ok = false;
+        if (!ok) std::cerr << "Error al escribir la captura " << ruta << "\n";
+        return ok;
+    }
+
+    // YUV 4:2:0: Y por píxel, U y V por bloque de 2x2 (BT.601, rango limitado)
+    const size_t nY = size_t(ancho) * alto;
+    codificado.resize(nY + nY / 2);
+    uint8_t* Y = codificado.data();
+    uint8_t* U = Y + nY;
+    uint8_t* V = U + nY / 4;
+    for (int y = 0; y < alto; ++y) {
+        const uint8_t* s = im.rgba.data() + size_t(alto - 1 - y) * fila;
+        for (int x = 0; x < ancho; ++x, s += 4)
+            Y[size_t(y) * ancho + x] = uint8_t(16 + ((66 * s[0] + 129 * s[1] + 25 * s[2] + 128) >> 8));
+    }
+    for (int y = 0; y < alto; y += 2) {
+        const uint8_t* s0 = im.rgba.data() + size_t(alto - 1 - y) * fila;
+        const uint8_t* s1 = s0 - fila;
+        for (int x = 0; x < ancho; x += 2, s0 += 8, s1 += 8) {
+            const int r = s0[0] + s0[4] + s1[0] + s1[4];
+            const int g = s0[1] + s0[5] + s1[1] + s1[5];
+            const int b = s0[2] + s0[6] + s1[2] + s1[6];
+            const size_t j = size_t(y / 2) * (ancho / 2) + x / 2;
+            U[j] = uint8_t(128 + ((-38 * r - 74 * g + 112 * b + 512) >> 10));
+            V[j] = uint8_t(128 + ((112 * r - 94 * g - 18 * b + 512) >> 10));
+        }
+    }
+    if (std::fwrite(codificado.data(), 1, codificado.size(), video) != codificado.size()) {
+        std::cerr << "Error al escribir el vídeo " << destino << " (frame " << im.numero << ")\n";
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+void GrabadorFrames::cerrar() {
+    if (!cola) return;
+    // Los pendientes, del más viejo al más nuevo
+    for (int k = 0; k < NUM_PBO_CAPTURA; ++k) {
+        const int i = (siguiente + k) % NUM_PBO_CAPTURA;
+        if (fences[i]) entregar(i);
+    }
+    cola->cerrar();
+    if (hilo.joinable()) hilo.join();
+    cola.reset();
+    libres.reset();
+
+    glDeleteBuffers(NUM_PBO_CAPTURA, pbos);
+    for (GLuint& p : pbos) p = 0;
+    if (video) {
+        const int r = esTuberia ? pclose(video) : std::fclose(video);
+        if (r != 0) std::cerr << "Error al cerrar el vídeo " << destino << "\n";
+        video = nullptr;
+    }
+}
@@ -0,0 +1,129 @@
+#include <render/camara.hpp>
+#include <render/impostores.hpp>
+#include <render/programa.hpp>
+
+namespace {
+
+// Todo en espacio de cámara: el ojo está en el origen y el rayo de cada fragmento
+// es la dirección hacia el punto del quad.
+const char* vertexShaderSource = "#version 330 core\n" GLSL_BLOQUE_CAMARA R"(
+    layout(location = 2) in vec4 aPosRadio;
+    layout(location = 3) in vec3 aColor;
+
+    out vec3 PuntoQuad;
+    flat out vec3 Centro;
+    flat out float Radio;
+    flat out vec3 ObjectColor;
+
+    // Límites de la silueta a lo largo de un eje en el plano del centro. En el plano
+    // (eje, profundidad) las dos rectas desde el ojo tangentes al círculo de radio r
+    // cortan ese plano en el mínimo y el máximo. Fuera del eje óptico la silueta es una
+    // elipse, más ancha que r*d/sqrt(d²-r²) hacia los bordes de la pantalla.
+    vec2 limitesSilueta(float c, float prof, float r){
+        float l2 = c * c + prof * prof;
+        float t2 = l2 - r * r;
+        if (t2 <= 0.0001 * l2) return vec2(c - 4.0 * r, c + 4.0 * r); // cámara dentro
+        float t = sqrt(t2);
+        // Dirección al centro girada ±asin(r/l)
+        vec2 menor = vec2(c * t - prof * r, prof * t + c * r);
+        vec2 mayor = vec2(c * t + prof * r, prof * t - c * r);
+        // Una tangente que no va hacia delante no corta el plano: se cubre lo que se pueda
+        float eps = 0.0001 * l2;
+        return vec2(menor.y > eps ? prof * menor.x / menor.y : c - 64.0 * r,
+                    mayor.y > eps ? prof * mayor.x / mayor.y : c + 64.0 * r);
+    }
+
+    void main(){
+        vec2 esquina = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+        Centro = vec3(view * vec4(aPosRadio.xyz, 1.0));
+        Radio = aPosRadio.w;
+        ObjectColor = aColor;
+
+        // El quad es el rectángulo que contiene la silueta en perspectiva, en el plano z
+        // del centro (la profundidad es -z en espacio de cámara)
+        vec2 limX = limitesSilueta(Centro.x, -Centro.z, Radio);
+        vec2 limY = limitesSilueta(Centro.y, -Centro.z, Radio);
+        PuntoQuad = vec3(mix(limX.x, limX.y, esquina.x), mix(limY.x, limY.y, esquina.y), Centro.z);
+        gl_Position = projection * vec4(PuntoQuad, 1.0);
+    }
+)";
+
+const char* fragmentShaderSource = "#version 330 core\n" GLSL_BLOQUE_CAMARA R"(
+    out vec4 FragColor;
+
+    in vec3 PuntoQuad;
+    flat in vec3 Centro;
+    flat in float Radio;
+    flat in vec3 ObjectColor;
+
+    void main(){
+        // Intersección del rayo t*dir con la esfera: t² - 2bt + |c|² - r² = 0
+        vec3 dir = normalize(PuntoQuad);
+        float b = dot(dir, Centro);
+        float h = b * b - dot(Centro, Centro) + Radio * Radio;
+        if (h < 0.0) discard;
+        float t = b - sqrt(h);
+        if (t <= 0.0) discard; // la cámara está dentro o detrás
+        vec3 FragPos = t * dir;
+        vec3 norm = (FragPos - Centro) / Radio;
+
+        vec4 clip = projection * vec4(FragPos, 1.0);
+        gl_FragDepth = 0.5 * clip.z / clip.w + 0.5;
+
+        // Phong igual que la malla, con la luz pasada a espacio de cámara
+        vec3 luz = vec3(view * vec4(lightPos.xyz, 1.0));
+
+        // Ambient
+        float ambientStrength = 0.2;
+        vec3 ambient = ambientStrength * lightColor.rgb;
+
+        // Diffuse
+        vec3 lightDir = normalize(luz - FragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor.rgb;
+
+        // Specular
+        float specularStrength = 0.5;
+        vec3 viewDir = -dir;
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+        vec3 specular = specularStrength * spec * lightColor.rgb;
+
+        vec3 result = (ambient + diffuse + specular) * ObjectColor;
+        FragColor = vec4(result, 1.0);
+    }
+)";
+
+} // namespace
+
+bool RenderImpostores::iniciar() {
+    programa = crearPrograma(vertexShaderSource, fragmentShaderSource);
+    if (!programa || !enlazarBloqueCamara(programa)) return false;
+
+    // Sin malla: las esquinas del quad salen de gl_VertexID
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glBindVertexArray(0);
+    return true;
+}
+
+void RenderImpostores::dibujar(GLuint buffer, size_t primera, size_t n) {
+    if (n == 0) return;
+
+    glUseProgram(programa);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    apuntarInstancias(primera);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(n));
+    glBindVertexArray(0);
+}
+
+void RenderImpostores::destruir() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(programa);
+    vao = programa = 0;
+}
@@ -0,0 +1,58 @@
+#include <render/programa.hpp>
+
+#include <iostream>
+#include <string>
+
+namespace {
+
+GLuint compilar(GLenum tipo, const char* fuente) {
+    GLuint s = glCreateShader(tipo);
+    glShaderSource(s, 1, &fuente, NULL);
+    glCompileShader(s);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        GLint largo = 0;
+        glGetShaderiv(s, GL_INFO_LOG_LENGTH, &largo);
+        std::string log(size_t(largo > 0 ? largo : 1), '\0');
+        glGetShaderInfoLog(s, GLsizei(log.size()), NULL, &log[0]);
+        std::cerr << "Error al compilar el shader de " << (tipo == GL_VERTEX_SHADER ? "vértices" : "fragmentos")
+                  << ":\n" << log.c_str() << "\n";
+        glDeleteShader(s);
+        return 0;
+    }
+    return s;
+}
+
+} // namespace
+
+GLuint crearPrograma(const char* fuenteVertices, const char* fuenteFragmentos) {
+    GLuint vertexShader = compilar(GL_VERTEX_SHADER, fuenteVertices);
+    GLuint fragmentShader = compilar(GL_FRAGMENT_SHADER, fuenteFragmentos);
+    if (!vertexShader || !fragmentShader) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint programa = glCreateProgram();
+    glAttachShader(programa, vertexShader);
+    glAttachShader(programa, fragmentShader);
+    glLinkProgram(programa);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(programa, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        GLint largo = 0;
+        glGetProgramiv(programa, GL_INFO_LOG_LENGTH, &largo);
+        std::string log(size_t(largo > 0 ? largo : 1), '\0');
+        glGetProgramInfoLog(programa, GLsizei(log.size()), NULL, &log[0]);
+        std::cerr << "Error al enlazar el programa de shaders:\n" << log.c_str() << "\n";
+        glDeleteProgram(programa);
+        return 0;
+    }
+    return programa;
+}
@@ -0,0 +1,35 @@
+#include <render/recorte.hpp>
+
+#include <cmath>
+
+Frustum extraerFrustum(const DatosCamara& camara, float altoPixeles, float radioMinPx) {
+    // Fila i de M = projection * view (glm guarda por columnas: m[col][fila])
+    const glm::mat4 m = camara.projection * camara.view;
+    auto fila = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+    const glm::vec4 planos[6] = {
+        fila(3) + fila(0), fila(3) - fila(0), // izquierda, derecha
+        fila(3) + fila(1), fila(3) - fila(1), // abajo, arriba
+        fila(3) + fila(2), fila(3) - fila(2), // cerca, lejos
+    };
+
+    Frustum f;
+    for (int k = 0; k < 6; ++k) {
+        const glm::vec4& pl = planos[k];
+        const float inv = 1.0f / std::sqrt(pl.x * pl.x + pl.y * pl.y + pl.z * pl.z);
+        f.a[k] = pl.x * inv;
+        f.b[k] = pl.y * inv;
+        f.c[k] = pl.z * inv;
+        f.d[k] = pl.w * inv;
+    }
+
+    // La cámara mira hacia -z: profundidad = -(fila 2 de view) · (x, y, z, 1)
+    const glm::mat4& v = camara.view;
+    f.zx = -v[0][2];
+    f.zy = -v[1][2];
+    f.zz = -v[2][2];
+    f.zw = -v[3][2];
+    f.focal = 0.5f * altoPixeles * camara.projection[1][1];
+    f.radioMinPx = radioMinPx;
+    for (float& r : f.radioMaxNivel) r = 0.0f;
+    return f;
+}
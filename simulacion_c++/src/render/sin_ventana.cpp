@@ -0,0 +1,93 @@
+#include <render/sin_ventana.hpp>
+
+#include <iostream>
+
+#ifdef GRAVEDAD_CON_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+bool ContextoSinVentana::crear(int ancho, int alto) {
+    auto obtenerDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay d = obtenerDisplay ? obtenerDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL)
+                                  : EGL_NO_DISPLAY;
+    EGLint mayor = 0, menor = 0;
+    if (d == EGL_NO_DISPLAY || !eglInitialize(d, &mayor, &menor)) {
+        std::cerr << "Error al crear el contexto sin ventana: no hay display EGL surfaceless\n";
+        return false;
+    }
+    display = d;
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint atributosConfig[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = NULL;
+    EGLint numConfigs = 0;
+    eglChooseConfig(d, atributosConfig, &config, 1, &numConfigs);
+
+    const EGLint atributosContexto[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                        EGL_NONE};
+    EGLContext c = eglCreateContext(d, numConfigs ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, atributosContexto);
+    if (c == EGL_NO_CONTEXT || !eglMakeCurrent(d, EGL_NO_SURFACE, EGL_NO_SURFACE, c)) {
+        std::cerr << "Error al crear el contexto sin ventana: EGL no da un contexto GL 3.3 core\n";
+        if (c != EGL_NO_CONTEXT) eglDestroyContext(d, c);
+        return false;
+    }
+    contexto = c;
+
+    if (!gladLoadGLLoader((GLADloadproc)cargar)) {
+        std::cerr << "Error al inicializar GLAD\n";
+        return false;
+    }
+
+    // Sin superficie no hay framebuffer por defecto: uno propio
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, ancho, alto);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glGenRenderbuffers(1, &profundidad);
+    glBindRenderbuffer(GL_RENDERBUFFER, profundidad);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, ancho, alto);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, profundidad);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Error al crear el framebuffer sin ventana de " << ancho << "x" << alto << "\n";
+        return false;
+    }
+    glViewport(0, 0, ancho, alto);
+    std::cout << "Sin ventana: " << glGetString(GL_RENDERER) << ", GL " << glGetString(GL_VERSION) << "\n";
+    return true;
+}
+
+void ContextoSinVentana::destruir() {
+    if (!display) return;
+    if (contexto) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &color);
+        glDeleteRenderbuffers(1, &profundidad);
+        fbo = color = profundidad = 0;
+        eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext((EGLDisplay)display, (EGLContext)contexto);
+    }
+    eglTerminate((EGLDisplay)display);
+    display = contexto = nullptr;
+}
+
+void* ContextoSinVentana::cargar(const char* nombre) {
+    return (void*)eglGetProcAddress(nombre);
+}
+
+#else
+
+bool ContextoSinVentana::crear(int, int) {
+    std::cerr << "Error al crear el contexto sin ventana: compilado sin EGL\n";
+    return false;
+}
+
+void ContextoSinVentana::destruir() {}
+
+void* ContextoSinVentana::cargar(const char*) {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,183 @@
+#include <gravedad/reproductor.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+bool ReproductorTrayectoria::abrir(const std::string& ruta) {
+    cerrar();
+    if (!lector.abrir(ruta)) return false;
+    if (lector.numFrames() == 0) {
+        std::cerr << "Trayectoria " << ruta << ": no contiene frames\n";
+        lector.cerrar();
+        return false;
+    }
+    salir = false;
+    stats = EstadisticasReproduccion();
+    ultimoChunk = SIZE_MAX;
+    sentido = 1;
+    hilo = std::thread([this] { bucle(); });
+    return true;
+}
+
+void ReproductorTrayectoria::cerrar() {
+    if (hilo.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            salir = true;
+        }
+        cv.notify_one();
+        hilo.join();
+    }
+    cache.clear();
+    pendientes.clear();
+    lector.cerrar();
+}
+
+EstadisticasReproduccion ReproductorTrayectoria::estadisticas() const {
+    std::lock_guard<std::mutex> lock(m);
+    return stats;
+}
+
+// Con el mutex tomado
+ReproductorTrayectoria::Chunk ReproductorTrayectoria::buscarEnCache(size_t c) {
+    for (size_t i = 0; i < cache.size(); ++i) {
+        if (cache[i].first != c) continue;
+        // Se mueve al final: el primero es siempre el menos usado
+        std::rotate(cache.begin() + i, cache.begin() + i + 1, cache.end());
+        return cache.back().second;
+    }
+    return nullptr;
+}
+
+// Con el mutex tomado
+void ReproductorTrayectoria::guardarEnCache(size_t c, Chunk chunk) {
+    if (buscarEnCache(c)) return;
+    if (cache.size() >= CHUNKS_EN_CACHE) cache.erase(cache.begin());
+    cache.emplace_back(c, std::move(chunk));
+}
+
+ReproductorTrayectoria::Chunk ReproductorTrayectoria::obtener(size_t c) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (Chunk chunk = buscarEnCache(c)) {
+            stats.aciertos++;
+            return chunk;
+        }
+        stats.fallos++;
+    }
+
+    // El prefetch no llegó a tiempo (o hubo un salto): se decodifica aquí
+    ZONA("decodificar chunk");
+    auto frames = std::make_shared<std::vector<FrameTrayectoria>>();
+    if (!lector.leerChunk(c, *frames)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(m);
+    guardarEnCache(c, frames);
+    return frames;
+}
+
+void ReproductorTrayectoria::pedirPrecarga(size_t c) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        for (const auto& e : cache)
+            if (e.first == c) return;
+        if (std::find(pendientes.begin(), pendientes.end(), c) != pendientes.end()) return;
+        pendientes.push_back(c);
+    }
+    cv.notify_one();
+}
+
+void ReproductorTrayectoria::bucle() {
+    NOMBRAR_HILO("reproductor precarga");
+    for (;;) {
+        size_t c;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this] { return salir || !pendientes.empty(); });
+            if (salir) return;
+            c = pendientes.front();
+            pendientes.erase(pendientes.begin());
+        }
+
+        auto decodificado = std::make_shared<std::vector<FrameTrayectoria>>();
+        {
+            ZONA("precarga chunk");
+            if (!lector.leerChunk(c, *decodificado)) continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m);
+        guardarEnCache(c, std::move(decodificado));
+        stats.precargados++;
+    }
+}
+
+// El índice del archivo puede tener huecos: el frame tiene que caer dentro del chunk
+static bool dentroDelChunk(const std::vector<FrameTrayectoria>& chunk, const EntradaIndiceTrayectoria& e, uint64_t t) {
+    return t >= e.primerFrame && t - e.primerFrame < chunk.size();
+}
+
+static bool mismosCuerpos(const FrameTrayectoria& a, const FrameTrayectoria& b) {
+    return a.ids.size() == b.ids.size()
+        && std::memcmp(a.ids.data(), b.ids.data(), a.ids.size() * sizeof(uint32_t)) == 0;
+}
+
+bool ReproductorTrayectoria::muestrear(double posicion, FrameTrayectoria& salida) {
+    const uint64_t total = lector.numFrames();
+    if (total == 0) return false;
+
+    posicion = std::min(std::max(posicion, 0.0), double(total - 1));
+    const uint64_t f0 = uint64_t(posicion);
+    const uint64_t f1 = std::min(f0 + 1, total - 1);
+    const double alfa = posicion - double(f0);
+
+    const size_t c0 = lector.buscarChunk(f0);
+    Chunk chunk0 = obtener(c0);
+    if (!chunk0 || !dentroDelChunk(*chunk0, lector.entrada(c0), f0)) return false;
+    const FrameTrayectoria& a = (*chunk0)[f0 - lector.entrada(c0).primerFrame];
+
+    // Read-ahead en el sentido de la reproducción: los chunks siguientes se decodifican
+    // en el hilo de fondo y el de después se pide al sistema de archivos
+    if (c0 != ultimoChunk) {
+        if (ultimoChunk != SIZE_MAX) sentido = c0 > ultimoChunk ? 1 : -1;
+        ultimoChunk = c0;
+        for (size_t k = 1; k <= CHUNKS_ADELANTE + 1; ++k) {
+            const long long c = (long long)c0 + sentido * (long long)k;
+            if (c < 0 || size_t(c) >= lector.numChunks()) break;
+            if (k <= CHUNKS_ADELANTE) pedirPrecarga(size_t(c));
+            else lector.precargar(size_t(c));
+        }
+    }
+
+    if (f1 == f0 || alfa == 0.0) {
+        salida = a;
+        return true;
+    }
+
+    const size_t c1 = lector.buscarChunk(f1);
+    Chunk chunk1 = c1 == c0 ? chunk0 : obtener(c1);
+    if (!chunk1 || !dentroDelChunk(*chunk1, lector.entrada(c1), f1)) {
+        salida = a;
+        return true;
+    }
+    const FrameTrayectoria& b = (*chunk1)[f1 - lector.entrada(c1).primerFrame];
+
+    if (!mismosCuerpos(a, b)) {
+        salida = alfa < 0.5 ? a : b;
+        return true;
+    }
+
+    const size_t n = a.ids.size();
+    const float t = float(alfa);
+    salida.tiempo = a.tiempo + (b.tiempo - a.tiempo) * alfa;
+    salida.ids = a.ids;
+    salida.x.resize(n);
+    salida.y.resize(n);
+    salida.z.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        salida.x[i] = a.x[i] + (b.x[i] - a.x[i]) * t;
+        salida.y[i] = a.y[i] + (b.y[i] - a.y[i]) * t;
+        salida.z[i] = a.z[i] + (b.z[i] - a.z[i]) * t;
+    }
+    return true;
+}
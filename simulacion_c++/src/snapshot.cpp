@@ -0,0 +1,171 @@
+#include <gravedad/snapshot.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+
+namespace {
+
+const char MAGIA[8] = {'G', 'R', 'A', 'V', 'S', 'N', 'A', 'P'};
+
+bool hostLittleEndian() {
+    const uint16_t uno = 1;
+    return *reinterpret_cast<const uint8_t*>(&uno) == 1;
+}
+
+uint64_t alinear(uint64_t x) {
+    return (x + ALINEACION_SNAPSHOT - 1) / ALINEACION_SNAPSHOT * ALINEACION_SNAPSHOT;
+}
+
+// Región mmap; se libera cuando ya nadie la referencia
+struct RegionMapeada {
+    void* base;
+    size_t bytes;
+    ~RegionMapeada() { munmap(base, bytes); }
+};
+
+} // namespace
+
+bool escribirSnapshot(const std::string& ruta, const MetadatosSnapshot& meta, uint64_t numCuerpos,
+                      const std::vector<ColumnaSnapshot>& columnas) {
+    if (!hostLittleEndian()) {
+        std::cerr << "Los snapshots solo se pueden escribir en máquinas little-endian\n";
+        return false;
+    }
+
+    CabeceraSnapshot cab = {};
+    std::memcpy(cab.magia, MAGIA, sizeof(MAGIA));
+    cab.version = VERSION_SNAPSHOT;
+    cab.numColumnas = static_cast<uint32_t>(columnas.size());
+    cab.numCuerpos = numCuerpos;
+    cab.paso = meta.paso;
+    cab.tiempo = meta.tiempo;
+    cab.acumulador = meta.acumulador;
+    cab.offsetDirectorio = sizeof(CabeceraSnapshot);
+
+    std::vector<EntradaColumna> directorio(columnas.size());
+    uint64_t offset = alinear(sizeof(CabeceraSnapshot) + columnas.size() * sizeof(EntradaColumna));
+    for (size_t c = 0; c < columnas.size(); ++c) {
+        EntradaColumna& e = directorio[c];
+        e = {};
+        std::strncpy(e.nombre, columnas[c].nombre, sizeof(e.nombre) - 1);
+        e.tipo = static_cast<uint32_t>(columnas[c].tipo);
+        e.bytesElemento = columnas[c].bytesElemento;
+        e.offset = offset;
+        e.bytes = numCuerpos * e.bytesElemento;
+        offset = alinear(offset + e.bytes);
+    }
+
+    std::ofstream f(ruta, std::ios::binary | std::ios::trunc);
+    if (!f) {
+        std::cerr << "Error al crear el snapshot " << ruta << "\n";
+        return false;
+    }
+
+    static const char ceros[ALINEACION_SNAPSHOT] = {};
+    f.write(reinterpret_cast<const char*>(&cab), sizeof(cab));
+    f.write(reinterpret_cast<const char*>(directorio.data()), directorio.size() * sizeof(EntradaColumna));
+    uint64_t escrito = sizeof(cab) + directorio.size() * sizeof(EntradaColumna);
+    for (size_t c = 0; c < columnas.size(); ++c) {
+        f.write(ceros, directorio[c].offset - escrito);
+        f.write(static_cast<const char*>(columnas[c].datos), directorio[c].bytes);
+        escrito = directorio[c].offset + directorio[c].bytes;
+    }
+    f.write(ceros, alinear(escrito) - escrito);
+
+    if (!f) {
+        std::cerr << "Error al escribir el snapshot " << ruta << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotMapeado::abrir(const std::string& ruta) {
+    if (!hostLittleEndian()) {
+        std::cerr << "Los snapshots solo se pueden leer en máquinas little-endian\n";
+        return false;
+    }
+
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error al abrir el snapshot " << ruta << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CabeceraSnapshot))) {
+        std::cerr << "Snapshot " << ruta << " vacío o ilegible\n";
+        close(fd);
+        return false;
+    }
+
+    // MAP_PRIVATE + PROT_WRITE: las columnas adoptadas se pueden modificar (copy-on-write)
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        std::cerr << "Error al mapear el snapshot " << ruta << "\n";
+        return false;
+    }
+    madvise(mem, bytes, MADV_WILLNEED);
+
+    std::shared_ptr<RegionMapeada> region(new RegionMapeada{mem, bytes});
+    base = static_cast<uint8_t*>(mem);
+    cabecera = reinterpret_cast<const CabeceraSnapshot*>(base);
+
+    if (std::memcmp(cabecera->magia, MAGIA, sizeof(MAGIA)) != 0) {
+        std::cerr << "Snapshot " << ruta << ": no es un archivo .grav\n";
+        cabecera = nullptr;
+        return false;
+    }
+    if (cabecera->version > VERSION_SNAPSHOT) {
+        std::cerr << "Snapshot " << ruta << ": versión " << cabecera->version << " no soportada\n";
+        cabecera = nullptr;
+        return false;
+    }
+
+    // Comparaciones sin desbordamiento: los offsets vienen del archivo
+    const uint64_t offsetDir = cabecera->offsetDirectorio;
+    if (offsetDir > bytes || cabecera->numColumnas > (bytes - offsetDir) / sizeof(EntradaColumna)) {
+        std::cerr << "Snapshot " << ruta << ": directorio truncado\n";
+        cabecera = nullptr;
+        return false;
+    }
+    if (offsetDir % alignof(EntradaColumna) != 0) {
+        std::cerr << "Snapshot " << ruta << ": directorio desalineado\n";
+        cabecera = nullptr;
+        return false;
+    }
+    directorio = reinterpret_cast<const EntradaColumna*>(base + offsetDir);
+    for (uint32_t c = 0; c < cabecera->numColumnas; ++c) {
+        const EntradaColumna& e = directorio[c];
+        if (e.offset > bytes || e.bytes > bytes - e.offset || e.offset % ALINEACION_SNAPSHOT != 0) {
+            std::cerr << "Snapshot " << ruta << ": columna " << c << " fuera del archivo o desalineada\n";
+            cabecera = nullptr;
+            return false;
+        }
+    }
+
+    propietario = region;
+    return true;
+}
+
+MetadatosSnapshot SnapshotMapeado::metadatos() const {
+    MetadatosSnapshot m;
+    if (cabecera) {
+        m.paso = cabecera->paso;
+        m.tiempo = cabecera->tiempo;
+        m.acumulador = cabecera->acumulador;
+    }
+    return m;
+}
+
+const EntradaColumna* SnapshotMapeado::buscar(const char* nombre) const {
+    if (!cabecera) return nullptr;
+    for (uint32_t c = 0; c < cabecera->numColumnas; ++c) {
+        if (std::strncmp(directorio[c].nombre, nombre, sizeof(directorio[c].nombre)) == 0) return &directorio[c];
+    }
+    return nullptr;
+}
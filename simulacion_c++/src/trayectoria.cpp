@@ -0,0 +1,540 @@
+#include <gravedad/trayectoria.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef GRAVEDAD_CON_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+const char MAGIA_TRAYECTORIA[8] = {'G', 'R', 'A', 'V', 'T', 'R', 'A', 'Y'};
+const char MAGIA_CHUNK[4] = {'C', 'H', 'N', 'K'};
+const char MAGIA_INDICE[8] = {'G', 'R', 'A', 'V', 'I', 'N', 'D', 'X'};
+
+template <typename T>
+void anadirBytes(std::vector<uint8_t>& out, const T* datos, size_t n) {
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(datos);
+    out.insert(out.end(), b, b + n * sizeof(T));
+}
+
+void escribirVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(uint8_t(v));
+}
+
+bool leerVarint(const uint8_t*& p, const uint8_t* fin, uint64_t& v) {
+    v = 0;
+    for (int desplazamiento = 0; p < fin && desplazamiento < 64; desplazamiento += 7) {
+        uint8_t b = *p++;
+        v |= uint64_t(b & 0x7f) << desplazamiento;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+int64_t deszigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+uint32_t bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, 4);
+    return u;
+}
+
+float desdeBits(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, 4);
+    return f;
+}
+
+// CODIFICAR LAS COORDENADAS DE UN CHUNK
+// xyz está ordenado por frame: [f][coord][cuerpo].
+void codificar(CodecTrayectoria codec, double errorMax, const std::vector<float>& xyz, uint32_t numFrames,
+               size_t n, std::vector<uint8_t>& out) {
+    auto valor = [&](uint32_t f, int k, size_t i) { return xyz[(size_t(f) * 3 + k) * n + i]; };
+
+    switch (codec) {
+    case CodecTrayectoria::CRUDO:
+        anadirBytes(out, xyz.data(), xyz.size());
+        break;
+
+    case CodecTrayectoria::CUANTIZADO: {
+        // Cada cuerpo es una serie temporal de enteros: solo se guarda su variación
+        const double paso = 2.0 * errorMax;
+        for (int k = 0; k < 3; ++k) {
+            for (size_t i = 0; i < n; ++i) {
+                int64_t anterior = 0;
+                for (uint32_t f = 0; f < numFrames; ++f) {
+                    int64_t q = std::llround(double(valor(f, k, i)) / paso);
+                    escribirVarint(out, zigzag(q - anterior));
+                    anterior = q;
+                }
+            }
+        }
+        break;
+    }
+
+    case CodecTrayectoria::XOR: {
+        // XOR con el frame anterior deja casi todo a cero en los bytes altos;
+        // separar los 4 bytes en planos junta esos ceros para zstd
+        std::vector<uint32_t> palabras(size_t(numFrames) * n);
+        for (int k = 0; k < 3; ++k) {
+            for (uint32_t f = 0; f < numFrames; ++f) {
+                for (size_t i = 0; i < n; ++i) {
+                    uint32_t w = bits(valor(f, k, i));
+                    if (f > 0) w ^= bits(valor(f - 1, k, i));
+                    palabras[size_t(f) * n + i] = w;
+                }
+            }
+            for (int b = 0; b < 4; ++b) {
+                for (uint32_t w : palabras) out.push_back(uint8_t(w >> (8 * b)));
+            }
+        }
+        break;
+    }
+    }
+}
+
+bool decodificar(CodecTrayectoria codec, double errorMax, const uint8_t* p, const uint8_t* fin,
+                 uint32_t numFrames, size_t n, std::vector<FrameTrayectoria>& frames) {
+    for (auto& fr : frames) {
+        fr.x.resize(n);
+        fr.y.resize(n);
+        fr.z.resize(n);
+    }
+    auto destino = [&](uint32_t f, int k) -> std::vector<float>& {
+        return k == 0 ? frames[f].x : (k == 1 ? frames[f].y : frames[f].z);
+    };
+
+    switch (codec) {
+    case CodecTrayectoria::CRUDO: {
+        if (size_t(fin - p) < size_t(numFrames) * 3 * n * sizeof(float)) return false;
+        for (uint32_t f = 0; f < numFrames; ++f) {
+            for (int k = 0; k < 3; ++k) {
+                std::memcpy(destino(f, k).data(), p, n * sizeof(float));
+                p += n * sizeof(float);
+            }
+        }
+        return true;
+    }
+
+    case CodecTrayectoria::CUANTIZADO: {
+        if (!(errorMax > 0.0) || !std::isfinite(errorMax)) return false;
+        const double paso = 2.0 * errorMax;
+        for (int k = 0; k < 3; ++k) {
+            for (size_t i = 0; i < n; ++i) {
+                int64_t q = 0;
+                for (uint32_t f = 0; f < numFrames; ++f) {
+                    uint64_t v;
+                    if (!leerVarint(p, fin, v)) return false;
+                    q += deszigzag(v);
+                    destino(f, k)[i] = float(double(q) * paso);
+                }
+            }
+        }
+        return true;
+    }
+
+    case CodecTrayectoria::XOR: {
+        const size_t palabrasPorCoord = size_t(numFrames) * n;
+        if (size_t(fin - p) < 3 * 4 * palabrasPorCoord) return false;
+        std::vector<uint32_t> palabras(palabrasPorCoord);
+        for (int k = 0; k < 3; ++k) {
+            std::fill(palabras.begin(), palabras.end(), 0u);
+            for (int b = 0; b < 4; ++b) {
+                for (size_t w = 0; w < palabrasPorCoord; ++w) palabras[w] |= uint32_t(*p++) << (8 * b);
+            }
+            for (uint32_t f = 0; f < numFrames; ++f) {
+                for (size_t i = 0; i < n; ++i) {
+                    uint32_t w = palabras[size_t(f) * n + i];
+                    if (f > 0) w ^= bits(destino(f - 1, k)[i]);
+                    destino(f, k)[i] = desdeBits(w);
+                }
+            }
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+// Tamaño codificado posible para lo que dice la cabecera del chunk: tiempos, ids y
+// entre 1 (varint) y 10 bytes por coordenada en CUANTIZADO, 4 justos en los demás.
+// Se comprueba antes de reservar nada; sin desbordamientos con valores absurdos.
+bool tamanoCodificadoValido(const CabeceraChunk& cab) {
+    uint64_t minCoord, maxCoord;
+    switch (static_cast<CodecTrayectoria>(cab.codec)) {
+    case CodecTrayectoria::CRUDO:
+    case CodecTrayectoria::XOR: minCoord = maxCoord = sizeof(float); break;
+    case CodecTrayectoria::CUANTIZADO: minCoord = 1; maxCoord = 10; break;
+    default: return false;
+    }
+    if (cab.numCuerpos >= UINT32_MAX) return false;
+    const uint64_t n = cab.numCuerpos;
+    const uint64_t ids = n * sizeof(uint32_t);
+    const uint64_t maxPorFrame = sizeof(double) + 3 * n * maxCoord;
+    if (cab.numFrames > (UINT64_MAX - ids) / maxPorFrame) return false;
+    const uint64_t minimo = cab.numFrames * (sizeof(double) + 3 * n * minCoord) + ids;
+    const uint64_t maximo = cab.numFrames * maxPorFrame + ids;
+    return cab.bytesCodificados >= minimo && cab.bytesCodificados <= maximo;
+}
+
+} // namespace
+
+// ---------------------------------- ESCRITOR ----------------------------------
+
+bool EscritorTrayectoria::abrir(const std::string& ruta_, const OpcionesTrayectoria& opciones_) {
+    cerrar();
+    ruta = ruta_;
+    opciones = opciones_;
+    if (opciones.framesPorChunk == 0) opciones.framesPorChunk = 1;
+#ifndef GRAVEDAD_CON_ZSTD
+    if (opciones.zstd) {
+        std::cerr << "Trayectoria: compilado sin zstd, los chunks se guardan sin comprimir\n";
+        opciones.zstd = false;
+    }
+#endif
+
+    archivo = std::fopen(ruta.c_str(), "wb");
+    if (!archivo) {
+        std::cerr << "Error al crear la trayectoria " << ruta << "\n";
+        return false;
+    }
+
+    CabeceraTrayectoria cab = {};
+    std::memcpy(cab.magia, MAGIA_TRAYECTORIA, sizeof(cab.magia));
+    cab.version = VERSION_TRAYECTORIA;
+    cab.codec = uint32_t(opciones.codec);
+    cab.framesPorChunk = opciones.framesPorChunk;
+    cab.errorMax = opciones.errorMax;
+    if (std::fwrite(&cab, sizeof(cab), 1, archivo) != 1) {
+        std::cerr << "Error al escribir la trayectoria " << ruta << "\n";
+        std::fclose(archivo);
+        archivo = nullptr;
+        return false;
+    }
+
+    actual = Chunk();
+    framesTotales = 0;
+    indice.clear();
+    error = false;
+    {
+        std::lock_guard<std::mutex> lock(mStats);
+        stats = EstadisticasTrayectoria();
+    }
+    cola.reset(new ColaAcotada<Chunk>(opciones.chunksEnCola));
+    hilo = std::thread([this] { bucleEscritura(); });
+    return true;
+}
+
+void EscritorTrayectoria::anadirFrame(const float* x, const float* y, const float* z, const uint32_t* ids,
+                                      size_t n, double tiempo) {
+    if (!archivo) return;
+
+    // Un chunk solo admite frames con el mismo conjunto de cuerpos
+    if (actual.numFrames > 0
+        && (actual.ids.size() != n || std::memcmp(actual.ids.data(), ids, n * sizeof(uint32_t)) != 0))
+        enviarChunk();
+
+    if (actual.numFrames == 0) {
+        actual.primerFrame = framesTotales;
+        actual.ids.assign(ids, ids + n);
+        actual.xyz.reserve(size_t(opciones.framesPorChunk) * 3 * n);
+    }
+    actual.tiempos.push_back(tiempo);
+    actual.xyz.insert(actual.xyz.end(), x, x + n);
+    actual.xyz.insert(actual.xyz.end(), y, y + n);
+    actual.xyz.insert(actual.xyz.end(), z, z + n);
+    actual.numFrames++;
+    framesTotales++;
+    {
+        std::lock_guard<std::mutex> lock(mStats);
+        stats.frames++;
+    }
+
+    if (actual.numFrames >= opciones.framesPorChunk) enviarChunk();
+}
+
+void EscritorTrayectoria::enviarChunk() {
+    if (actual.numFrames == 0) return;
+    bool espero = false;
+    cola->meter(std::move(actual), &espero);
+    if (espero) {
+        std::lock_guard<std::mutex> lock(mStats);
+        stats.esperas++;
+    }
+    actual = Chunk();
+}
+
+void EscritorTrayectoria::bucleEscritura() {
+    NOMBRAR_HILO("trayectoria E/S");
+    Chunk c;
+    while (cola->sacar(c)) escribirChunk(c);
+}
+
+void EscritorTrayectoria::escribirChunk(const Chunk& c) {
+    if (error) return; // tras un fallo el archivo ya está incompleto
+    ZONA("trayectoria chunk");
+    const size_t n = c.ids.size();
+    std::vector<uint8_t> codificado;
+    codificado.reserve(c.tiempos.size() * 8 + n * 4 + c.xyz.size() * 4);
+    anadirBytes(codificado, c.tiempos.data(), c.tiempos.size());
+    anadirBytes(codificado, c.ids.data(), n);
+    codificar(opciones.codec, opciones.errorMax, c.xyz, c.numFrames, n, codificado);
+
+    CabeceraChunk cab = {};
+    std::memcpy(cab.magia, MAGIA_CHUNK, sizeof(cab.magia));
+    cab.codec = uint32_t(opciones.codec);
+    cab.numFrames = c.numFrames;
+    cab.numCuerpos = n;
+    cab.primerFrame = c.primerFrame;
+    cab.bytesCodificados = codificado.size();
+    cab.errorMax = opciones.errorMax;
+
+    const std::vector<uint8_t>* datos = &codificado;
+#ifdef GRAVEDAD_CON_ZSTD
+    std::vector<uint8_t> comprimido;
+    if (opciones.zstd) {
+        comprimido.resize(ZSTD_compressBound(codificado.size()));
+        size_t r = ZSTD_compress(comprimido.data(), comprimido.size(), codificado.data(), codificado.size(), 3);
+        if (!ZSTD_isError(r) && r < codificado.size()) {
+            comprimido.resize(r);
+            datos = &comprimido;
+            cab.zstd = 1;
+        }
+    }
+#endif
+    cab.bytesGuardados = datos->size();
+
+    EntradaIndiceTrayectoria e;
+    e.primerFrame = c.primerFrame;
+    e.numFrames = c.numFrames;
+    const off_t offset = ftello(archivo);
+    e.offset = uint64_t(offset);
+    if (offset < 0 || std::fwrite(&cab, sizeof(cab), 1, archivo) != 1
+        || std::fwrite(datos->data(), 1, datos->size(), archivo) != datos->size()) {
+        std::cerr << "Error al escribir la trayectoria " << ruta << " (chunk del frame " << c.primerFrame << ")\n";
+        error = true;
+        std::lock_guard<std::mutex> lock(mStats);
+        stats.error = true;
+        return;
+    }
+    indice.push_back(e);
+
+    std::lock_guard<std::mutex> lock(mStats);
+    stats.chunks++;
+    stats.bytesCrudos += c.xyz.size() * sizeof(float);
+    stats.bytesEscritos += sizeof(cab) + datos->size();
+}
+
+void EscritorTrayectoria::cerrar() {
+    if (!archivo) return;
+    enviarChunk();
+    cola->cerrar();
+    hilo.join();
+    cola.reset();
+
+    // Sin índice el lector recorre los chunks escritos (ver reconstruirIndice)
+    bool ok = !error;
+    if (ok) {
+        PieTrayectoria pie = {};
+        const off_t offset = ftello(archivo);
+        pie.offsetIndice = uint64_t(offset);
+        pie.numChunks = indice.size();
+        pie.numFrames = framesTotales;
+        std::memcpy(pie.magia, MAGIA_INDICE, sizeof(pie.magia));
+        ok = offset >= 0
+            && std::fwrite(indice.data(), sizeof(EntradaIndiceTrayectoria), indice.size(), archivo) == indice.size()
+            && std::fwrite(&pie, sizeof(pie), 1, archivo) == 1;
+    }
+    if (std::ferror(archivo)) ok = false;
+    if (std::fclose(archivo) != 0) ok = false;
+    if (!ok) {
+        std::cerr << "Error al escribir la trayectoria " << ruta << ": el archivo está incompleto\n";
+        std::lock_guard<std::mutex> lock(mStats);
+        stats.error = true;
+    }
+    archivo = nullptr;
+}
+
+// ---------------------------------- LECTOR ------------------------------------
+
+bool LectorTrayectoria::abrir(const std::string& ruta) {
+    cerrar();
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error al abrir la trayectoria " << ruta << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CabeceraTrayectoria)) {
+        std::cerr << "Trayectoria " << ruta << ": vacía o ilegible\n";
+        close(fd);
+        return false;
+    }
+    bytes = size_t(st.st_size);
+    void* mem = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        std::cerr << "Error al mapear la trayectoria " << ruta << "\n";
+        bytes = 0;
+        return false;
+    }
+    base = static_cast<uint8_t*>(mem);
+
+    CabeceraTrayectoria cab;
+    std::memcpy(&cab, base, sizeof(cab));
+    if (std::memcmp(cab.magia, MAGIA_TRAYECTORIA, 8) != 0) {
+        std::cerr << "Trayectoria " << ruta << ": no es un archivo .tray\n";
+        cerrar();
+        return false;
+    }
+    if (cab.version > VERSION_TRAYECTORIA) {
+        std::cerr << "Trayectoria " << ruta << ": versión " << cab.version << " no soportada\n";
+        cerrar();
+        return false;
+    }
+
+    // Índice al final; si no está (escritura interrumpida) se reconstruye
+    PieTrayectoria pie;
+    bool conIndice = false;
+    if (bytes >= sizeof(cab) + sizeof(pie)) {
+        std::memcpy(&pie, base + bytes - sizeof(pie), sizeof(pie));
+        const uint64_t finIndice = bytes - sizeof(pie);
+        conIndice = std::memcmp(pie.magia, MAGIA_INDICE, 8) == 0 && pie.offsetIndice <= finIndice
+            && pie.numChunks <= (finIndice - pie.offsetIndice) / sizeof(EntradaIndiceTrayectoria);
+    }
+    if (conIndice) {
+        indice.resize(pie.numChunks);
+        std::memcpy(indice.data(), base + pie.offsetIndice, indice.size() * sizeof(EntradaIndiceTrayectoria));
+        framesTotales = pie.numFrames;
+    } else {
+        reconstruirIndice();
+    }
+    return true;
+}
+
+bool LectorTrayectoria::reconstruirIndice() {
+    indice.clear();
+    framesTotales = 0;
+    uint64_t offset = sizeof(CabeceraTrayectoria);
+    CabeceraChunk cab;
+    while (offset + sizeof(cab) <= bytes) {
+        std::memcpy(&cab, base + offset, sizeof(cab));
+        // Un chunk a medio escribir al final se descarta
+        if (std::memcmp(cab.magia, MAGIA_CHUNK, 4) != 0 || cab.bytesGuardados > bytes - offset - sizeof(cab)) break;
+        indice.push_back({cab.primerFrame, cab.numFrames, offset});
+        framesTotales = cab.primerFrame + cab.numFrames;
+        offset += sizeof(cab) + cab.bytesGuardados;
+    }
+    return true;
+}
+
+void LectorTrayectoria::cerrar() {
+    if (base) munmap(base, bytes);
+    base = nullptr;
+    bytes = 0;
+    indice.clear();
+    framesTotales = 0;
+    chunkEnCache = SIZE_MAX;
+    cache.clear();
+}
+
+size_t LectorTrayectoria::buscarChunk(uint64_t t) const {
+    size_t lo = 0, hi = indice.size();
+    while (hi - lo > 1) {
+        size_t medio = (lo + hi) / 2;
+        if (indice[medio].primerFrame <= t) lo = medio;
+        else hi = medio;
+    }
+    return lo;
+}
+
+const CabeceraChunk* LectorTrayectoria::cabeceraChunk(size_t c) const {
+    if (c >= indice.size()) return nullptr;
+    const uint64_t offset = indice[c].offset;
+    if (offset > bytes || sizeof(CabeceraChunk) > bytes - offset) return nullptr;
+    const CabeceraChunk* cab = reinterpret_cast<const CabeceraChunk*>(base + offset);
+    if (cab->bytesGuardados > bytes - offset - sizeof(CabeceraChunk)) return nullptr;
+    // El índice y la cabecera tienen que contar lo mismo: leerFrame indexa con el índice
+    if (cab->primerFrame != indice[c].primerFrame || cab->numFrames != indice[c].numFrames) return nullptr;
+    return cab;
+}
+
+bool LectorTrayectoria::leerChunk(size_t c, std::vector<FrameTrayectoria>& frames) const {
+    const CabeceraChunk* cab = cabeceraChunk(c);
+    if (!cab) return false;
+    return decodificarChunk(*cab, reinterpret_cast<const uint8_t*>(cab + 1), frames);
+}
+
+void LectorTrayectoria::precargar(size_t c) const {
+    const CabeceraChunk* cab = cabeceraChunk(c);
+    if (!cab) return;
+    // madvise exige una dirección alineada a página
+    const uintptr_t pagina = uintptr_t(sysconf(_SC_PAGESIZE));
+    uintptr_t inicio = uintptr_t(cab) & ~(pagina - 1);
+    uintptr_t fin = uintptr_t(cab + 1) + cab->bytesGuardados;
+    madvise(reinterpret_cast<void*>(inicio), fin - inicio, MADV_WILLNEED);
+}
+
+bool LectorTrayectoria::leerFrame(uint64_t t, FrameTrayectoria& frame) {
+    if (!base || t >= framesTotales) return false;
+
+    size_t c = buscarChunk(t);
+    if (c != chunkEnCache) {
+        if (!leerChunk(c, cache)) return false;
+        chunkEnCache = c;
+    }
+
+    if (t < indice[c].primerFrame || t - indice[c].primerFrame >= cache.size()) return false;
+    frame = cache[t - indice[c].primerFrame];
+    return true;
+}
+
+bool LectorTrayectoria::decodificarChunk(const CabeceraChunk& cab, const uint8_t* datos,
+                                         std::vector<FrameTrayectoria>& frames) {
+    if (!tamanoCodificadoValido(cab) || (!cab.zstd && cab.bytesGuardados != cab.bytesCodificados)) return false;
+    std::vector<uint8_t> descomprimido;
+    const uint8_t* p = datos;
+    const uint8_t* fin = datos + cab.bytesGuardados;
+    if (cab.zstd) {
+#ifdef GRAVEDAD_CON_ZSTD
+        descomprimido.resize(cab.bytesCodificados);
+        size_t r = ZSTD_decompress(descomprimido.data(), descomprimido.size(), datos, cab.bytesGuardados);
+        if (ZSTD_isError(r) || r != cab.bytesCodificados) return false;
+        p = descomprimido.data();
+        fin = p + descomprimido.size();
+#else
+        std::cerr << "Trayectoria comprimida con zstd, pero se compiló sin zstd\n";
+        return false;
+#endif
+    }
+
+    const size_t n = cab.numCuerpos;
+    if (size_t(fin - p) < cab.numFrames * sizeof(double) + n * sizeof(uint32_t)) return false;
+    frames.resize(cab.numFrames);
+    for (uint32_t f = 0; f < cab.numFrames; ++f) {
+        std::memcpy(&frames[f].tiempo, p, sizeof(double));
+        p += sizeof(double);
+    }
+    for (uint32_t f = 0; f < cab.numFrames; ++f) {
+        frames[f].ids.resize(n);
+        std::memcpy(frames[f].ids.data(), p, n * sizeof(uint32_t));
+    }
+    p += n * sizeof(uint32_t);
+
+    return decodificar(static_cast<CodecTrayectoria>(cab.codec), cab.errorMax, p, fin, cab.numFrames, n, frames);
+}